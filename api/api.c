@@ -516,47 +516,54 @@ static int API_env_set(va_list ap)
  */
 static int API_env_enum(va_list ap)
 {
-	int i, buflen;
-	char *last, **next, *s;
-	struct env_entry *match, search;
+	struct env_entry *match, *found = NULL;
+	char *last, **next, *key = NULL, *s;
 	static char *var;
+	int i, buflen;
 
 	last = (char *)va_arg(ap, unsigned long);
 
 	if ((next = (char **)va_arg(ap, uintptr_t)) == NULL)
 		return API_EINVAL;
 
-	if (last == NULL) {
-		var = NULL;
-		i = 0;
-	} else {
-		var = strdup(last);
-		s = strchr(var, '=');
+	if (last != NULL) {
+		key = strdup(last);
+		if (!key)
+			return API_ENOMEM;
+		s = strchr(key, '=');
 		if (s != NULL)
 			*s = 0;
-		search.key = var;
-		i = hsearch_r(search, ENV_FIND, &match, &env_htab, 0);
-		if (i == 0) {
-			i = API_EINVAL;
-			goto done;
-		}
 	}
 
-	/* match the next entry after i */
-	i = hmatch_r("", i, &match, &env_htab);
-	if (i == 0)
-		goto done;
-	buflen = strlen(match->key) + strlen(match->data) + 2;
-	var = realloc(var, buflen);
-	snprintf(var, buflen, "%s=%s", match->key, match->data);
-	*next = var;
-	return 0;
+	/*
+	 * Return the entry with the next key in sorted order. This does not
+	 * depend on where entries are in the table, so the walk is not upset
+	 * if variables are changed and the table is resized between calls.
+	 */
+	for (i = hmatch_r("", 0, &match, &env_htab); i;
+	     i = hmatch_r("", i, &match, &env_htab)) {
+		if (key && strcmp(match->key, key) <= 0)
+			continue;
+		if (!found || strcmp(match->key, found->key) < 0)
+			found = match;
+	}
+	free(key);
 
-done:
+	/* last normally points to var, so it is only freed now */
 	free(var);
 	var = NULL;
 	*next = NULL;
-	return i;
+	if (!found)
+		return 0;
+
+	buflen = strlen(found->key) + strlen(found->data) + 2;
+	var = malloc(buflen);
+	if (!var)
+		return API_ENOMEM;
+	snprintf(var, buflen, "%s=%s", found->key, found->data);
+	*next = var;
+
+	return 0;
 }
 
 /*
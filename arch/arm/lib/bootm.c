@@ -79,6 +79,9 @@ static void announce_and_cleanup(int fake)
 	/* Remove all active vital devices next */
 	dm_remove_devices_flags(DM_REMOVE_ACTIVE_ALL);
 
+	/* Write out any log output still waiting for the console */
+	log_console_flush();
+
 	cleanup_before_linux();
 }
 
@@ -23,6 +23,7 @@
 #include <command.h>
 #include <cpu_func.h>
 #include <irq_func.h>
+#include <log.h>
 #include <linux/delay.h>
 #include <stdio.h>
 
@@ -38,6 +39,7 @@ int do_reset(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 	disable_interrupts();
 
 	reset_misc();
+	log_console_flush();
 	reset_cpu();
 
 	/*NOTREACHED*/
@@ -130,6 +130,10 @@ int riscv_cpu_setup(void)
 		csr_write(CSR_FCSR, 0);
 	}
 
+	/* Enable the vector unit, which is used by memcpy() and memset() */
+	if (IS_ENABLED(CONFIG_RISCV_ISA_V) && supports_extension('v'))
+		csr_set(MODE_PREFIX(status), SR_VS_INITIAL);
+
 	if (CONFIG_IS_ENABLED(RISCV_MMODE)) {
 		/*
 		 * Enable perf counters for cycle, time,
@@ -10,6 +10,7 @@
 #include <errno.h>
 #include <log.h>
 #include <os.h>
+#include <parallel.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <asm/malloc.h>
@@ -32,6 +33,8 @@ unsigned long map_len;
 
 void __noreturn sandbox_exit(void)
 {
+	log_console_flush();
+
 	/* Do this here while it still has an effect */
 	os_fd_restore();
 
@@ -378,6 +381,20 @@ fail:
 	return NULL;
 }
 
+#if CONFIG_IS_ENABLED(PARALLEL)
+/* Use host threads as CPUs, so that parallel_for() can be tested */
+int arch_parallel_num_cpus(void)
+{
+	return CONFIG_PARALLEL_MAX_CPUS;
+}
+
+int arch_parallel_run(int nr_cpus, void (*func)(void *ctx, int cpu),
+		      void *ctx)
+{
+	return os_run_parallel(nr_cpus, func, ctx);
+}
+#endif
+
 ulong timer_get_boot_us(void)
 {
 	static uint64_t base_count;
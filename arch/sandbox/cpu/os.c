@@ -1106,6 +1106,60 @@ void os_relaunch(char *argv[])
 	os_exit(1);
 }
 
+struct os_thread_arg {
+	void (*func)(void *ctx, int cpu);
+	void *ctx;
+	int cpu;
+};
+
+static void *os_thread_entry(void *ptr)
+{
+	struct os_thread_arg *arg = ptr;
+
+	arg->func(arg->ctx, arg->cpu);
+
+	return NULL;
+}
+
+int os_run_parallel(int nr_threads, void (*func)(void *ctx, int cpu),
+		    void *ctx)
+{
+	struct os_thread_arg *args;
+	pthread_t *tids;
+	int ret = 0;
+	int i;
+
+	if (nr_threads < 1)
+		return -EINVAL;
+	args = calloc(nr_threads, sizeof(*args));
+	tids = calloc(nr_threads, sizeof(*tids));
+	if (!args || !tids) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < nr_threads; i++) {
+		args[i].func = func;
+		args[i].ctx = ctx;
+		args[i].cpu = i;
+	}
+
+	/* Thread 0 is the caller; only start the others */
+	for (i = 1; i < nr_threads; i++) {
+		if (pthread_create(&tids[i], NULL, os_thread_entry, &args[i]))
+			break;
+	}
+	nr_threads = i;
+	os_thread_entry(&args[0]);
+	for (i = 1; i < nr_threads; i++)
+		pthread_join(tids[i], NULL);
+out:
+	free(tids);
+	free(args);
+
+	return ret;
+}
+
 
 #ifdef CONFIG_FUZZ
 static void *fuzzer_thread(void * ptr)
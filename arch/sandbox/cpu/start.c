@@ -464,6 +464,8 @@ void __efi_runtime EFIAPI efi_reset_system(
 
 void sandbox_reset(void)
 {
+	log_console_flush();
+
 	/* Do this here while it still has an effect */
 	os_fd_restore();
 	if (state_uninit())
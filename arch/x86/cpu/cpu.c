@@ -284,6 +284,8 @@ int cpu_init_r(void)
 	if (ret)
 		return ret;
 
+	x86_string_init();
+
 	/*
 	 * Set up the northbridge, PCH and LPC if available. Note that these
 	 * may have had some limited pre-relocation init if they were probed
@@ -29,6 +29,10 @@ extern void *memmove(void *, const void *, __kernel_size_t);
 #undef __HAVE_ARCH_MEMSET
 extern void *memset(void *, int, __kernel_size_t);
 
+static inline void x86_string_init(void)
+{
+}
+
 #else
 
 #define __HAVE_ARCH_MEMCPY
@@ -40,6 +44,13 @@ extern void *memmove(void *, const void *, __kernel_size_t);
 #define __HAVE_ARCH_MEMSET
 extern void *memset(void *, int, __kernel_size_t);
 
+/**
+ * x86_string_init() - Select the fastest memory routines for this CPU
+ *
+ * This must only be called after relocation.
+ */
+void x86_string_init(void);
+
 #endif /* CONFIG_X86_64 */
 
 #undef __HAVE_ARCH_MEMCHR
@@ -50,6 +50,9 @@ void bootm_announce_and_cleanup(void)
 	 * of DMA operation or releasing device internal buffers.
 	 */
 	dm_remove_devices_flags(DM_REMOVE_ACTIVE_ALL);
+
+	/* Write out any log output still waiting for the console */
+	log_console_flush();
 }
 
 #if defined(CONFIG_OF_LIBFDT) && !defined(CONFIG_OF_NO_KERNEL)
@@ -7,12 +7,34 @@
 
 /* From glibc-2.14, sysdeps/i386/memset.c */
 
+#include <linux/bitops.h>
 #include <linux/types.h>
 #include <linux/compiler.h>
+#include <asm/cpu.h>
 #include <asm/string.h>
 
 typedef uint32_t op_t;
 
+/* CPUID.(EAX=7,ECX=0):EBX bit for Enhanced REP MOVSB/STOSB */
+#define CPUID_7_EBX_ERMS	BIT(9)
+
+/* Size above which REP MOVSB/STOSB is faster than word moves with ERMS */
+#define ERMS_THRES	256
+
+/*
+ * Set by x86_string_init() if the CPU has ERMS. This is in .data since .bss
+ * overlaps the relocation tables until U-Boot has relocated. It is only set
+ * after relocation, since .data may still be in read-only flash before that,
+ * so the pre-relocation code always uses the word-based routines.
+ */
+static bool use_erms __section(".data");
+
+void x86_string_init(void)
+{
+	if (cpuid_eax(0) >= 7 && (cpuid_ext(7, 0).ebx & CPUID_7_EBX_ERMS))
+		use_erms = true;
+}
+
 void *memset(void *dstpp, int c, size_t len)
 {
 	int d0;
@@ -26,6 +48,18 @@ void *memset(void *dstpp, int c, size_t len)
 	/* Clear the direction flag, so filling will move forward.  */
 	asm volatile("cld");
 
+	/* With ERMS, the microcode fills whole cache lines for us */
+	if (use_erms && len >= ERMS_THRES) {
+		asm volatile(
+			"rep\n"
+			"stosb" :
+			"=D" (dstp), "=c" (d0) :
+			"0" (dstp), "1" (len), "a" (x) :
+			"memory");
+
+		return dstpp;
+	}
+
 	/* This threshold value is optimal.  */
 	if (len >= 12) {
 		/* Fill X with four copies of the char we want to fill with. */
@@ -108,6 +142,12 @@ void *memcpy(void *dstpp, const void *srcpp, size_t len)
 
 	/* Copy from the beginning to the end.  */
 
+	/* With ERMS, a byte copy moves whole cache lines at a time */
+	if (use_erms && len >= ERMS_THRES) {
+		BYTE_COPY_FWD(dstp, srcp, len);
+		return dstpp;
+	}
+
 	/* If there not too few bytes to copy, use word copy.  */
 	if (len >= OP_T_THRES) {
 		/* Copy just a few bytes to make DSTP aligned.  */
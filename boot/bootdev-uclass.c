@@ -10,6 +10,7 @@
 #include <bootdev.h>
 #include <bootflow.h>
 #include <bootmeth.h>
+#include <bootstage.h>
 #include <bootstd.h>
 #include <fs.h>
 #include <log.h>
@@ -705,6 +706,76 @@ int bootdev_next_prio(struct bootflow_iter *iter, struct udevice **devp)
 	return 0;
 }
 
+/**
+ * bootdev_hunter_match() - Check if a hunter is selected by a label
+ *
+ * @info: Hunter to check
+ * @spec: Label to check, e.g. "mmc1", or NULL to match any hunter
+ * Return: true if @info should be used for @spec
+ */
+static bool bootdev_hunter_match(struct bootdev_hunter *info, const char *spec)
+{
+	const char *name = uclass_get_name(info->uclass);
+	const char *end;
+	size_t len;
+
+	if (!spec)
+		return true;
+	trailing_strtoln_end(spec, NULL, &end);
+	len = end - spec;
+
+	log_debug("looking at %.*s for %s\n",
+		  (int)max(strlen(name), len), spec, name);
+	if (!strncmp(spec, name, max(strlen(name), len)))
+		return true;
+
+	return info->uclass == UCLASS_ETH &&
+		(!strcmp("dhcp", spec) || !strcmp("pxe", spec));
+}
+
+void bootdev_hunt_ahead(const char *const *labels, bool show)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+
+	if (bootstd_get_priv(&std))
+		return;
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0; i < n_ent; i++) {
+		struct bootdev_hunter *info = start + i;
+		const char *name = uclass_get_name(info->uclass);
+		const char *const *label;
+		int ret;
+
+		if (!info->start || (std->hunters_used & BIT(i)))
+			continue;
+		for (label = labels; label && *label; label++) {
+			if (bootdev_hunter_match(info, *label))
+				break;
+		}
+		if (labels && !*label)
+			continue;
+
+		if (show)
+			printf("Starting hunter: %s\n", name);
+		ret = info->start(info, show);
+		log_debug("Started hunter %s: %d\n", name, ret);
+
+		/* any error is reported when the hunter is used */
+		if (ret)
+			continue;
+		if (!std->hunters_started) {
+			bootstage_start(BOOTSTAGE_ID_ACCUM_HUNT_AHEAD,
+					"hunt_ahead");
+			std->hunt_ahead_us = 0;
+		}
+		std->hunters_started |= BIT(i);
+	}
+}
+
 int bootdev_setup_iter(struct bootflow_iter *iter, const char *label,
 		       struct udevice **devp, int *method_flagsp)
 {
@@ -783,6 +854,9 @@ int bootdev_setup_iter(struct bootflow_iter *iter, const char *label,
 		if (!ok)
 			return log_msg_ret("ord", -ENOMEM);
 		log_debug("setup labels %p\n", iter->labels);
+		if (IS_ENABLED(CONFIG_BOOTSTD_HUNT_AHEAD) &&
+		    (iter->flags & BOOTFLOWIF_HUNT))
+			bootdev_hunt_ahead(iter->labels, show);
 		if (iter->labels) {
 			iter->cur_label = -1;
 			ret = bootdev_next_label(iter, &dev, &method_flags);
@@ -820,8 +894,16 @@ static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show)
 			printf("Hunting with: %s\n",
 			       uclass_get_name(info->uclass));
 		log_debug("Hunting with: %s\n", name);
+		if (std->hunters_started & BIT(seq)) {
+			/* the scan has caught up with the background hunters */
+			std->hunt_ahead_us =
+				bootstage_accum(BOOTSTAGE_ID_ACCUM_HUNT_AHEAD);
+			std->hunters_started = 0;
+		}
 		if (info->hunt) {
+			bootstage_start(BOOTSTAGE_ID_ACCUM_HUNT, "hunt");
 			ret = info->hunt(info, show);
+			bootstage_accum(BOOTSTAGE_ID_ACCUM_HUNT);
 			log_debug("  - hunt result %d\n", ret);
 			if (ret && ret != -ENOENT)
 				return ret;
@@ -835,33 +917,19 @@ static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show)
 int bootdev_hunt(const char *spec, bool show)
 {
 	struct bootdev_hunter *start;
-	const char *end;
 	int n_ent, i;
 	int result;
-	size_t len;
 
 	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
 	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
 	result = 0;
 
-	len = SIZE_MAX;
-	if (spec) {
-		trailing_strtoln_end(spec, NULL, &end);
-		len = end - spec;
-	}
-
 	for (i = 0; i < n_ent; i++) {
 		struct bootdev_hunter *info = start + i;
-		const char *name = uclass_get_name(info->uclass);
 		int ret;
 
-		log_debug("looking at %.*s for %s\n",
-			  (int)max(strlen(name), len), spec, name);
-		if (spec && strncmp(spec, name, max(strlen(name), len))) {
-			if (info->uclass != UCLASS_ETH ||
-			    (strcmp("dhcp", spec) && strcmp("pxe", spec)))
-				continue;
-		}
+		if (!bootdev_hunter_match(info, spec))
+			continue;
 		ret = bootdev_hunt_drv(info, i, show);
 		if (ret)
 			result = ret;
@@ -11,9 +11,11 @@
 #include <bootmeth.h>
 #include <bootstd.h>
 #include <dm.h>
+#include <env.h>
 #include <env_internal.h>
 #include <malloc.h>
 #include <serial.h>
+#include <u-boot/crc.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 
@@ -453,6 +455,159 @@ int bootflow_scan_next(struct bootflow_iter *iter, struct bootflow *bflow)
 	} while (1);
 }
 
+/* This is also built for unit tests, so they can check it on any board */
+#if CONFIG_IS_ENABLED(BOOTFLOW_CACHE) || CONFIG_IS_ENABLED(UNIT_TEST)
+/* Environment variable holding the record written by bootflow_cache_save() */
+#define BOOTFLOW_CACHE_VAR	"bootflow_cache"
+
+/* Fields of the record, which are separated by spaces */
+enum {
+	BFC_HUNTER,	/* uclass name of the hunter for the bootdev, or "-" */
+	BFC_BOOTDEV,	/* bootdev name */
+	BFC_PART,	/* partition number, in hex */
+	BFC_BOOTMETH,	/* bootmeth name */
+	BFC_FNAME,	/* filename of the bootflow */
+	BFC_SIZE,	/* size of the file, in hex */
+	BFC_CRC,	/* CRC32 of the file, in hex */
+
+	BFC_COUNT,
+};
+
+/**
+ * bootflow_cache_hunter() - Find the name of the hunter for a bootdev
+ *
+ * @dev: Bootdev to check
+ * Return: uclass name of the hunter which creates bootdevs of this type, or
+ *	"-" if none
+ */
+static const char *bootflow_cache_hunter(struct udevice *dev)
+{
+	struct bootdev_hunter *start;
+	int n_ent, i;
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0; i < n_ent; i++) {
+		struct bootdev_hunter *info = start + i;
+
+		if (info->drv == dev->driver)
+			return uclass_get_name(info->uclass);
+	}
+
+	return "-";
+}
+
+static u32 bootflow_cache_crc(const struct bootflow *bflow)
+{
+	if (!bflow->buf)
+		return 0;
+
+	return crc32(0, (const uchar *)bflow->buf, bflow->size);
+}
+
+int bootflow_cache_save(const struct bootflow *bflow, bool save)
+{
+	struct bootmeth_uc_plat *ucp;
+	const char *old;
+	char rec[256];
+	int len, ret;
+
+	ucp = dev_get_uclass_plat(bflow->method);
+	if (!bflow->dev || (ucp->flags & BOOTMETHF_GLOBAL) || !bflow->fname ||
+	    strchr(bflow->fname, ' '))
+		return log_msg_ret("typ", -ENOTSUPP);
+
+	len = snprintf(rec, sizeof(rec), "%s %s %x %s %s %x %x",
+		       bootflow_cache_hunter(bflow->dev), bflow->dev->name,
+		       bflow->part, bflow->method->name, bflow->fname,
+		       bflow->size, bootflow_cache_crc(bflow));
+	if (len >= sizeof(rec))
+		return log_msg_ret("len", -E2BIG);
+
+	/* avoid writing the environment on every boot */
+	old = env_get(BOOTFLOW_CACHE_VAR);
+	if (old && !strcmp(old, rec))
+		return 0;
+	log_debug("Recording bootflow: %s\n", rec);
+	ret = env_set(BOOTFLOW_CACHE_VAR, rec);
+	if (ret)
+		return log_msg_ret("set", ret);
+	if (save) {
+		ret = env_save();
+		if (ret)
+			return log_msg_ret("sav", ret);
+	}
+
+	return 0;
+}
+
+int bootflow_cache_scan(struct bootflow_iter *iter, int flags,
+			struct bootflow *bflow)
+{
+	struct udevice *dev, *meth;
+	char *field[BFC_COUNT];
+	char rec[256], *p;
+	const char *val;
+	int ret, i;
+
+	bootflow_iter_init(iter, flags | BOOTFLOWIF_SKIP_GLOBAL |
+			   BOOTFLOWIF_SINGLE_DEV | BOOTFLOWIF_SINGLE_PARTITION);
+	val = env_get(BOOTFLOW_CACHE_VAR);
+	if (!val)
+		return log_msg_ret("env", -ENOENT);
+	strlcpy(rec, val, sizeof(rec));
+	for (i = 0, p = rec; i < BFC_COUNT; i++) {
+		field[i] = strsep(&p, " ");
+		if (!field[i])
+			return log_msg_ret("fld", -EINVAL);
+	}
+
+	/* The bootdev may only appear once its hunter has been run */
+	ret = uclass_find_device_by_name(UCLASS_BOOTDEV, field[BFC_BOOTDEV],
+					 &dev);
+	if (ret && (flags & BOOTFLOWIF_HUNT) && strcmp(field[BFC_HUNTER], "-")) {
+		ret = bootdev_hunt(field[BFC_HUNTER], flags & BOOTFLOWIF_SHOW);
+		if (ret)
+			return log_msg_ret("hun", ret);
+		ret = uclass_find_device_by_name(UCLASS_BOOTDEV,
+						 field[BFC_BOOTDEV], &dev);
+	}
+	if (ret)
+		return log_msg_ret("dev", ret);
+	ret = device_probe(dev);
+	if (ret)
+		return log_msg_ret("prb", ret);
+
+	ret = uclass_get_device_by_name(UCLASS_BOOTMETH, field[BFC_BOOTMETH],
+					&meth);
+	if (ret)
+		return log_msg_ret("met", ret);
+	iter->method_order = calloc(1, sizeof(struct udevice *));
+	if (!iter->method_order)
+		return log_msg_ret("mem", -ENOMEM);
+	iter->method_order[0] = meth;
+	iter->num_methods = 1;
+	iter->method = meth;
+	iter->part = hextoul(field[BFC_PART], NULL);
+	bootflow_iter_set_dev(iter, dev, 0);
+
+	ret = bootflow_check(iter, bflow);
+	if (ret) {
+		bootflow_free(bflow);
+		return log_msg_ret("chk", ret);
+	}
+	if (strcmp(bflow->fname, field[BFC_FNAME]) ||
+	    bflow->size != hextoul(field[BFC_SIZE], NULL) ||
+	    bootflow_cache_crc(bflow) != hextoul(field[BFC_CRC], NULL)) {
+		log_debug("Recorded bootflow '%s' has changed\n", bflow->name);
+		bootflow_free(bflow);
+		return log_msg_ret("crc", -ESTALE);
+	}
+
+	return 0;
+}
+#endif /* BOOTFLOW_CACHE || UNIT_TEST */
+
 void bootflow_init(struct bootflow *bflow, struct udevice *bootdev,
 		   struct udevice *meth)
 {
@@ -528,6 +683,13 @@ int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 	if (IS_ENABLED(CONFIG_OF_HAS_PRIOR_STAGE) &&
 	    (bflow->flags & BOOTFLOWF_USE_PRIOR_FDT))
 		printf("Using prior-stage device tree\n");
+	if (CONFIG_IS_ENABLED(BOOTFLOW_CACHE) && iter) {
+		bool save = IS_ENABLED(CONFIG_BOOTFLOW_CACHE_SAVE);
+
+		ret = bootflow_cache_save(bflow, save);
+		if (ret && ret != -ENOTSUPP)
+			log_warning("Failed to record bootflow (err=%dE)\n", ret);
+	}
 	ret = bootflow_boot(bflow);
 	if (!IS_ENABLED(CONFIG_BOOTSTD_FULL)) {
 		printf("Boot failed (err=%d)\n", ret);
@@ -25,6 +25,7 @@
 #include <asm/io.h>
 #include <malloc.h>
 #include <memalign.h>
+#include <of_overlay.h>
 #include <asm/global_data.h>
 #ifdef CONFIG_DM_HASH
 #include <dm.h>
@@ -2342,7 +2343,8 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 	ulong load, len;
 #ifdef CONFIG_OF_LIBFDT_OVERLAY
 	ulong image_start, image_end;
-	ulong ovload, ovlen, ovcopylen;
+	ulong ovload, ovlen, ovcopylen, ovtotal = 0;
+	struct of_overlay_ctx ovctx = {};
 	const char *uconfig;
 	const char *uname;
 	void *base, *ov, *ovcopy = NULL;
@@ -2400,6 +2402,16 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 
 	base = map_sysmem(load, len);
 
+	if (CONFIG_IS_ENABLED(OF_LIVE_OVERLAY)) {
+		err = of_overlay_start(&ovctx, base);
+		if (err) {
+			printf("failed to expand FDT for overlays (err=%d)\n",
+			       err);
+			fdt_noffset = err;
+			goto out;
+		}
+	}
+
 	/* apply extra configs in FIT first, followed by args */
 	for (i = 1; ; i++) {
 		if (i < count) {
@@ -2444,6 +2456,19 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 				uname, ovload, ovlen);
 		ov = map_sysmem(ovload, ovlen);
 
+		/* merge into the live tree, which is written out at the end */
+		if (CONFIG_IS_ENABLED(OF_LIVE_OVERLAY)) {
+			err = of_overlay_add(&ovctx, ov);
+			if (err) {
+				printf("failed to apply overlay %s (err=%d)\n",
+				       uname, err);
+				fdt_noffset = err;
+				goto out;
+			}
+			ovtotal += ovlen;
+			continue;
+		}
+
 		ovcopylen = ALIGN(fdt_totalsize(ov), SZ_4K);
 		ovcopy = malloc(ovcopylen);
 		if (!ovcopy) {
@@ -2476,6 +2501,18 @@ int boot_get_fdt_fit(struct bootm_headers *images, ulong addr,
 		fdt_pack(base);
 		len = fdt_totalsize(base);
 	}
+
+	if (CONFIG_IS_ENABLED(OF_LIVE_OVERLAY)) {
+		base = map_sysmem(load, len + ovtotal);
+		err = of_overlay_finish(&ovctx, base, len + ovtotal);
+		if (err) {
+			printf("failed to write FDT with overlays (err=%d)\n",
+			       err);
+			fdt_noffset = err;
+			goto out;
+		}
+		len = fdt_totalsize(base);
+	}
 #else
 	printf("config with overlays but CONFIG_OF_LIBFDT_OVERLAY not set\n");
 	fdt_noffset = -EBADF;
@@ -2493,6 +2530,8 @@ out:
 
 #ifdef CONFIG_OF_LIBFDT_OVERLAY
 	free(ovcopy);
+	if (CONFIG_IS_ENABLED(OF_LIVE_OVERLAY))
+		of_overlay_uninit(&ovctx);
 #endif
 	free(fit_uname_config_copy);
 	return fdt_noffset;
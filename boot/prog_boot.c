@@ -38,6 +38,14 @@ int bootstd_prog_boot(void)
 	show_bootmeths();
 	flags = BOOTFLOWIF_HUNT | BOOTFLOWIF_SHOW | BOOTFLOWIF_SKIP_GLOBAL;
 
+	if (IS_ENABLED(CONFIG_BOOTFLOW_CACHE)) {
+		if (!bootflow_cache_scan(&iter, flags, &bflow)) {
+			bootflow_run_boot(&iter, &bflow);
+			bootflow_free(&bflow);
+		}
+		bootflow_iter_uninit(&iter);
+	}
+
 	bootstd_clear_glob();
 	for (i = 0, ret = bootflow_scan_first(NULL, NULL, &iter, flags, &bflow);
 	     i < 1000 && ret != -ENODEV;
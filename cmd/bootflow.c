@@ -183,6 +183,16 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 	if (!no_hunter)
 		flags |= BOOTFLOWIF_HUNT;
 
+	/* Try the bootflow which was booted last time, if it is unchanged */
+	if (IS_ENABLED(CONFIG_BOOTFLOW_CACHE) && boot && !menu && !dev &&
+	    !label) {
+		if (!bootflow_cache_scan(&iter, flags, &bflow)) {
+			bootflow_run_boot(&iter, &bflow);
+			bootflow_free(&bflow);
+		}
+		bootflow_iter_uninit(&iter);
+	}
+
 	/*
 	 * If we have a device, just scan for bootflows attached to that device
 	 */
@@ -22,6 +22,7 @@
 #include <hash.h>
 #include <log.h>
 #include <mapmem.h>
+#include <memtest.h>
 #include <rand.h>
 #include <time.h>
 #include <watchdog.h>
@@ -1058,9 +1059,46 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	return errs;
 }
 
+static ulong mem_test_fast(vu_long *buf, ulong start_addr, ulong end_addr,
+			   ulong pattern, int iteration)
+{
+	struct memtest_result res;
+	const int plen = 2 * sizeof(ulong);
+	ulong errs = 0;
+	int test, ret;
+
+	/* Use the inverse pattern on alternate iterations */
+	if (iteration & 1)
+		pattern = ~pattern;
+
+	for (test = 0; test < MEMTEST_COUNT; test++) {
+		if (ctrlc())
+			return -1;
+		printf("\n  %-18s", memtest_name(test));
+		ret = memtest_run(test, (void *)buf, start_addr,
+				  end_addr - start_addr, pattern, &res);
+		if (ret) {
+			printf("failed (err=%d)\n", ret);
+			return -1;
+		}
+		printf("%6lu MB/s", memtest_bandwidth(&res));
+		if (res.errors) {
+			printf(", %lu error(s)\n  first @ 0x%0*lX: found %0*lX, expected %0*lX (bit %lu)",
+			       res.errors, plen, res.fail_addr, plen,
+			       res.actual, plen, res.expected,
+			       __ffs(res.actual ^ res.expected));
+		}
+		errs += res.errors;
+	}
+	puts("\n");
+
+	return errs;
+}
+
 /*
  * Perform a memory test. A more complete alternative test can be
- * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
+ * configured using CONFIG_SYS_ALT_MEMTEST, or a faster block-based one
+ * using CONFIG_SYS_MEMTEST_FAST. The complete test loops until
  * interrupted by ctrl-c or by a failure of one of the sub-tests.
  */
 static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
@@ -1114,7 +1152,10 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 
 		printf("Iteration: %6d\r", iteration + 1);
 		debug("\n");
-		if (IS_ENABLED(CONFIG_SYS_ALT_MEMTEST)) {
+		if (IS_ENABLED(CONFIG_SYS_MEMTEST_FAST)) {
+			errs = mem_test_fast(buf, start, end, pattern,
+					     iteration);
+		} else if (IS_ENABLED(CONFIG_SYS_ALT_MEMTEST)) {
 			errs = mem_test_alt(buf, start, end, dummy);
 			if (errs == -1UL)
 				break;
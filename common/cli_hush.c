@@ -320,10 +320,30 @@ typedef struct {
 /* used for initialization:
 	o_string foo = NULL_O_STRING; */
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+/*
+ * A script held in the parse cache: the parsed form of each line, in the
+ * order that parse_stream_outer() produced them
+ */
+struct hush_script {
+	char *text;			/* script text, NULL if entry unused */
+	uint hash;			/* hash of @text */
+	int flag;			/* flags the script was parsed with */
+	struct pipe **lists;		/* parsed lines */
+	int count;			/* number of entries in @lists */
+	int busy;			/* number of callers running the script */
+	int bad;			/* parsing failed, so do not cache */
+	ulong last_used;		/* value of script_age when last run */
+};
+#endif
+
 /* I can almost use ordinary FILE *.  Is open_memstream() universally
  * available?  Where is it documented? */
 struct in_str {
 	const unsigned char *p;
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	struct hush_script *script;	/* records parsed lines, or NULL */
+#endif
 #ifndef __U_BOOT__
 	char peek_buf[2];
 #endif
@@ -1159,6 +1179,9 @@ static void setup_file_in_str(struct in_str *i)
 	i->file = f;
 #endif
 	i->p = NULL;
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	i->script = NULL;
+#endif
 }
 
 static void setup_string_in_str(struct in_str *i, const char *s)
@@ -1168,6 +1191,9 @@ static void setup_string_in_str(struct in_str *i, const char *s)
 	i->__promptme=1;
 	i->promptmode=1;
 	i->p = s;
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	i->script = NULL;
+#endif
 }
 
 #ifndef __U_BOOT__
@@ -3173,6 +3199,217 @@ static void update_ifs_map(void)
 	mapset(ifs, 2);            /* also flow through if quoted */
 }
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+/*
+ * Parsing is the slow part of running a script, so keep the parsed form of
+ * recently run scripts, such as environment variables used with 'run' and
+ * boot scripts. Variables are only expanded when a command is run, so the
+ * parsed form depends only on the text and the parser flags. Each time a
+ * cached script is run, a copy of its parsed lines is made since running a
+ * line changes and then frees it.
+ */
+static struct hush_script script_cache[CONFIG_HUSH_PARSE_CACHE_ENTRIES];
+static ulong script_age;
+static uint script_hits;
+static bool script_ifs_set;
+
+static struct pipe *clone_pipe_list(struct pipe *head);
+
+static void clone_child(struct child_prog *dst, struct child_prog *src)
+{
+	int i;
+
+	*dst = *src;
+	if (src->argv) {
+		dst->argv = xmalloc((src->argc + 1) * sizeof(*dst->argv));
+		for (i = 0; i < src->argc; i++)
+			dst->argv[i] = xstrdup(src->argv[i]);
+		dst->argv[i] = NULL;
+		dst->argv_nonnull = xmalloc((src->argc + 1) *
+					    sizeof(*dst->argv_nonnull));
+		memcpy(dst->argv_nonnull, src->argv_nonnull,
+		       (src->argc + 1) * sizeof(*dst->argv_nonnull));
+	}
+	if (src->group)
+		dst->group = clone_pipe_list(src->group);
+}
+
+static struct pipe *clone_pipe_list(struct pipe *head)
+{
+	struct pipe *first = NULL, **link = &first;
+	struct pipe *pi;
+	int i;
+
+	for (; head; head = head->next) {
+		pi = xmalloc(sizeof(*pi));
+		*pi = *head;
+		pi->next = NULL;
+		if (head->progs) {
+			/* there is always a spare child after the last one */
+			pi->progs = xmalloc((head->num_progs + 1) *
+					    sizeof(*pi->progs));
+			for (i = 0; i < head->num_progs; i++)
+				clone_child(&pi->progs[i], &head->progs[i]);
+			pi->progs[i] = head->progs[i];
+			pi->progs[i].argv = NULL;
+			pi->progs[i].argv_nonnull = NULL;
+			pi->progs[i].group = NULL;
+		}
+		*link = pi;
+		link = &pi->next;
+	}
+
+	return first;
+}
+
+static uint script_hash(const char *s)
+{
+	uint hash = 2166136261U;
+
+	while (*s)
+		hash = (hash ^ (uchar)*s++) * 16777619;
+
+	return hash;
+}
+
+static void script_add_list(struct hush_script *script, struct pipe *head)
+{
+	script->lists = xrealloc(script->lists,
+				 (script->count + 1) * sizeof(*script->lists));
+	script->lists[script->count++] = clone_pipe_list(head);
+}
+
+static void script_free(struct hush_script *script)
+{
+	int i;
+
+	for (i = 0; i < script->count; i++)
+		free_pipe_list(script->lists[i], 0);
+	free(script->lists);
+	free(script->text);
+	memset(script, '\0', sizeof(*script));
+}
+
+/*
+ * IFS changes how scripts are parsed. It is hardly ever set, so track it with
+ * an environment callback rather than looking it up for every script.
+ */
+static int on_hush_ifs(const char *name, const char *value, enum env_op op,
+		       int flags)
+{
+	script_ifs_set = op != env_op_delete;
+
+	return 0;
+}
+U_BOOT_ENV_CALLBACK(hush_ifs, on_hush_ifs);
+
+/* the cache is not used for re-parsing expanded commands, nor if IFS is set */
+static bool script_cacheable(int flag)
+{
+	return !(flag & FLAG_REPARSING) && !script_ifs_set;
+}
+
+unsigned int hush_parse_cache_hits(void)
+{
+	return script_hits;
+}
+
+static struct hush_script *script_find(const char *s, int flag)
+{
+	struct hush_script *script;
+	uint hash = script_hash(s);
+
+	for (script = script_cache;
+	     script < script_cache + ARRAY_SIZE(script_cache); script++) {
+		if (script->text && script->hash == hash &&
+		    script->flag == flag && !strcmp(script->text, s))
+			return script;
+	}
+
+	return NULL;
+}
+
+/* start recording a new script, replacing the least recently used one */
+static struct hush_script *script_new(const char *s, int flag)
+{
+	struct hush_script *script, *victim = NULL;
+
+	for (script = script_cache;
+	     script < script_cache + ARRAY_SIZE(script_cache); script++) {
+		if (script->busy)
+			continue;
+		if (!victim || !script->text ||
+		    (victim->text && script->last_used < victim->last_used))
+			victim = script;
+		if (!victim->text)
+			break;
+	}
+	if (!victim)
+		return NULL;
+
+	script_free(victim);
+	victim->hash = script_hash(s);
+	victim->flag = flag;
+	victim->last_used = ++script_age;
+
+	return victim;
+}
+
+/* run each line of a cached script, as parse_stream_outer() would */
+static int script_run(struct hush_script *script)
+{
+	int code = 1;
+	int i;
+
+	script->last_used = ++script_age;
+	script->busy++;
+	for (i = 0; i < script->count; i++) {
+		code = run_list(clone_pipe_list(script->lists[i]));
+		if (code == -2)
+			break;
+		if (code == -1)
+			flag_repeat = 0;
+	}
+	script->busy--;
+	if (code == -2)
+		return -2;
+
+	return (code != 0) ? 1 : 0;
+}
+
+/* parse and run a string, using the cache if possible */
+static int parse_string_cached(struct in_str *input, const char *s, int flag)
+{
+	struct hush_script *script = NULL;
+	int rcode;
+
+	if (script_cacheable(flag)) {
+		script = script_find(s, flag);
+		if (script) {
+			script_hits++;
+			return script_run(script);
+		}
+		script = script_new(s, flag);
+	}
+
+	setup_string_in_str(input, s);
+	input->script = script;
+	if (script)
+		script->busy++;
+	rcode = parse_stream_outer(input, flag);
+	if (script) {
+		script->busy--;
+		/* only keep scripts which were parsed all the way through */
+		if (rcode == -2 || script->bad)
+			script_free(script);
+		else
+			script->text = xstrdup(s);
+	}
+
+	return rcode;
+}
+#endif /* CONFIG_HUSH_PARSE_CACHE */
+
 /* most recursion does not come through here, the exeception is
  * from builtin_source() */
 static int parse_stream_outer(struct in_str *inp, int flag)
@@ -3207,6 +3444,10 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #ifndef __U_BOOT__
 			run_list(ctx.list_head);
 #else
+#ifdef CONFIG_HUSH_PARSE_CACHE
+			if (inp->script)
+				script_add_list(inp->script, ctx.list_head);
+#endif
 			code = run_list(ctx.list_head);
 			if (code == -2) {	/* exit */
 				b_free(&temp);
@@ -3241,6 +3482,10 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 			temp.nonnull = 0;
 			temp.quote = 0;
 			inp->p = NULL;
+#ifdef CONFIG_HUSH_PARSE_CACHE
+			if (inp->script)
+				inp->script->bad = 1;
+#endif
 			free_pipe_list(ctx.list_head,0);
 		}
 		b_free(&temp);
@@ -3272,14 +3517,22 @@ int parse_string_outer(const char *s, int flag)
 		p = xmalloc(strlen(s) + 2);
 		strcpy(p, s);
 		strcat(p, "\n");
+#ifdef CONFIG_HUSH_PARSE_CACHE
+		rcode = parse_string_cached(&input, p, flag);
+#else
 		setup_string_in_str(&input, p);
 		rcode = parse_stream_outer(&input, flag);
+#endif
 		free(p);
 		return rcode == -2 ? last_return_code : rcode;
 	} else {
 #endif
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	rcode = parse_string_cached(&input, s, flag);
+#else
 	setup_string_in_str(&input, s);
 	rcode = parse_stream_outer(&input, flag);
+#endif
 	return rcode == -2 ? last_return_code : rcode;
 #ifdef __U_BOOT__
 	}
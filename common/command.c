@@ -15,6 +15,7 @@
 #include <env.h>
 #include <image.h>
 #include <log.h>
+#include <malloc.h>
 #include <mapmem.h>
 #include <time.h>
 #include <asm/global_data.h>
@@ -126,10 +127,87 @@ struct cmd_tbl *find_cmd_tbl(const char *cmd, struct cmd_tbl *table,
 	return NULL;	/* not found or ambiguous command */
 }
 
+#ifdef CONFIG_CMDLINE
+/*
+ * Commands sorted by name, so that find_cmd() can use a binary search rather
+ * than comparing against every command. This is set up on first use after
+ * relocation.
+ */
+static struct cmd_tbl **cmd_sorted;
+
+static struct cmd_tbl **get_sorted_cmds(struct cmd_tbl *table, int table_len)
+{
+	struct cmd_tbl **sorted, *cmdtp;
+	int i, j;
+
+	/* .bss is not available before relocation */
+	if (!(gd->flags & GD_FLG_RELOC))
+		return NULL;
+	if (cmd_sorted)
+		return cmd_sorted;
+
+	sorted = malloc(table_len * sizeof(*sorted));
+	if (!sorted)
+		return NULL;
+
+	/* The linker list is mostly in order already, so this is quick */
+	for (i = 0; i < table_len; i++) {
+		cmdtp = table + i;
+		for (j = i; j > 0 && strcmp(sorted[j - 1]->name, cmdtp->name) > 0;
+		     j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = cmdtp;
+	}
+	cmd_sorted = sorted;
+
+	return sorted;
+}
+
+/* find a command in a sorted table, with the same rules as find_cmd_tbl() */
+static struct cmd_tbl *find_sorted_cmd(const char *cmd, struct cmd_tbl **sorted,
+				       int table_len)
+{
+	int len, lo, hi, mid;
+	const char *p;
+
+	len = ((p = strchr(cmd, '.')) == NULL) ? strlen(cmd) : (p - cmd);
+
+	/* Find the first command which does not sort before @cmd */
+	lo = 0;
+	hi = table_len;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (strncmp(sorted[mid]->name, cmd, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == table_len || strncmp(sorted[lo]->name, cmd, len))
+		return NULL;
+
+	/* A full match sorts before any other command it abbreviates */
+	if (strlen(sorted[lo]->name) == len)
+		return sorted[lo];
+
+	/* An abbreviation must match exactly one command */
+	if (lo + 1 < table_len && !strncmp(sorted[lo + 1]->name, cmd, len))
+		return NULL;
+
+	return sorted[lo];
+}
+#endif /* CONFIG_CMDLINE */
+
 struct cmd_tbl *find_cmd(const char *cmd)
 {
 	struct cmd_tbl *start = ll_entry_start(struct cmd_tbl, cmd);
 	const int len = ll_entry_count(struct cmd_tbl, cmd);
+#ifdef CONFIG_CMDLINE
+	struct cmd_tbl **sorted;
+
+	sorted = get_sorted_cmds(start, len);
+	if (sorted && cmd)
+		return find_sorted_cmd(cmd, sorted, len);
+#endif
 	return find_cmd_tbl(cmd, start, len);
 }
 
@@ -11,6 +11,7 @@
 #include <env.h>
 #include <stdarg.h>
 #include <iomux.h>
+#include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
 #include <os.h>
@@ -538,23 +539,33 @@ int ftstc(int file)
 	return -1;
 }
 
+/*
+ * Deferred log output is written out first, so that it stays in order with
+ * output which does not go through putc() / puts()
+ */
 void fputc(int file, const char c)
 {
-	if ((unsigned int)file < MAX_FILES)
+	if ((unsigned int)file < MAX_FILES) {
+		log_console_flush();
 		console_putc(file, c);
+	}
 }
 
 void fputs(int file, const char *s)
 {
-	if ((unsigned int)file < MAX_FILES)
+	if ((unsigned int)file < MAX_FILES) {
+		log_console_flush();
 		console_puts(file, s);
+	}
 }
 
 #ifdef CONFIG_CONSOLE_FLUSH_SUPPORT
 void fflush(int file)
 {
-	if ((unsigned int)file < MAX_FILES)
+	if ((unsigned int)file < MAX_FILES) {
+		log_console_flush();
 		console_flush(file);
+	}
 }
 #endif
 
@@ -694,6 +705,9 @@ void putc(const char c)
 
 	console_record_putc(c);
 
+	if (CONFIG_IS_ENABLED(LOG_CONSOLE_DEFER) && log_console_defer(&c, 1))
+		return;
+
 	/* sandbox can send characters to stdout before it has a console */
 	if (IS_ENABLED(CONFIG_SANDBOX) && !(gd->flags & GD_FLG_SERIAL_READY)) {
 		os_putc(c);
@@ -735,6 +749,10 @@ void puts(const char *s)
 
 	console_record_puts(s);
 
+	if (CONFIG_IS_ENABLED(LOG_CONSOLE_DEFER) &&
+	    log_console_defer(s, strlen(s)))
+		return;
+
 	/* sandbox can send characters to stdout before it has a console */
 	if (IS_ENABLED(CONFIG_SANDBOX) && !(gd->flags & GD_FLG_SERIAL_READY)) {
 		os_puts(s);
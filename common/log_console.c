@@ -6,12 +6,135 @@
  * Written by Simon Glass <sjg@chromium.org>
  */
 
+#include <cyclic.h>
 #include <log.h>
+#include <membuff.h>
 #include <asm/global_data.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
-static int log_console_emit(struct log_device *ldev, struct log_rec *rec)
+#if CONFIG_IS_ENABLED(LOG_CONSOLE_DEFER)
+/*
+ * Log output waiting to be written to the console. This is only used after
+ * relocation, so that the buffer can be allocated and a cyclic function
+ * registered to drain it. Since these variables are in .bss, they must not be
+ * looked at before relocation.
+ */
+static struct membuff defer_buf;
+static bool defer_failed;	/* could not set up deferred output */
+static bool defer_capture;	/* console output is going into defer_buf */
+static bool defer_draining;	/* defer_buf is being written out */
+
+/**
+ * log_console_drain() - Write out deferred log output
+ *
+ * The output was recorded when it was generated, so it is not recorded again
+ * here
+ *
+ * @max: Maximum number of bytes to write, or -1 for all
+ */
+static void log_console_drain(int max)
+{
+	ulong record = gd->flags & GD_FLG_RECORD;
+	char buf[64];
+	int len;
+
+	/* the console may run cyclic functions while writing */
+	if (defer_draining)
+		return;
+	defer_draining = true;
+	gd->flags &= ~GD_FLG_RECORD;
+	while (max) {
+		len = sizeof(buf) - 1;
+		if (max > 0 && len > max)
+			len = max;
+		len = membuff_get(&defer_buf, buf, len);
+		if (!len)
+			break;
+		buf[len] = '\0';
+		puts(buf);
+		if (max > 0)
+			max -= len;
+	}
+	gd->flags |= record;
+	defer_draining = false;
+}
+
+static void log_console_cyclic(void *ctx)
+{
+	log_console_drain(CONFIG_LOG_CONSOLE_DEFER_CHUNK);
+}
+
+/* check that the cyclic function is registered, registering it if needed */
+static bool log_console_arm(void)
+{
+	struct cyclic_info *cyclic;
+
+	/* it may have been removed, e.g. by cyclic_unregister_all() */
+	hlist_for_each_entry(cyclic, cyclic_get_list(), list) {
+		if (cyclic->func == log_console_cyclic)
+			return true;
+	}
+
+	return cyclic_register(log_console_cyclic,
+			       CONFIG_LOG_CONSOLE_DEFER_DELAY_US, "log_console",
+			       NULL);
+}
+
+/* check whether log output can be deferred, setting it up if needed */
+static bool log_console_can_defer(void)
+{
+	if (!(gd->flags & GD_FLG_RELOC) || defer_failed)
+		return false;
+
+	if (!defer_buf.start &&
+	    membuff_new(&defer_buf, CONFIG_LOG_CONSOLE_DEFER_SIZE)) {
+		defer_failed = true;
+		return false;
+	}
+
+	return log_console_arm();
+}
+
+bool log_console_defer(const char *s, int len)
+{
+	if (!(gd->flags & GD_FLG_RELOC) || defer_draining || !defer_buf.start)
+		return false;
+
+	if (!defer_capture) {
+		/* keep log output in order with other console output */
+		if (!membuff_isempty(&defer_buf))
+			log_console_drain(-1);
+		return false;
+	}
+
+	if (membuff_free(&defer_buf) < len) {
+		log_console_drain(-1);
+		if (membuff_free(&defer_buf) < len)
+			return false;
+	}
+	membuff_put(&defer_buf, s, len);
+
+	return true;
+}
+
+void log_console_flush(void)
+{
+	if ((gd->flags & GD_FLG_RELOC) && defer_buf.start &&
+	    !membuff_isempty(&defer_buf))
+		log_console_drain(-1);
+}
+
+int log_console_pending(void)
+{
+	if (!(gd->flags & GD_FLG_RELOC) || !defer_buf.start)
+		return 0;
+
+	return membuff_avail(&defer_buf);
+}
+#endif /* LOG_CONSOLE_DEFER */
+
+static void log_console_show(struct log_rec *rec)
 {
 	int fmt = gd->log_fmt;
 	bool add_space = false;
@@ -47,6 +170,20 @@ static int log_console_emit(struct log_device *ldev, struct log_rec *rec)
 	}
 	if (fmt & BIT(LOGF_MSG))
 		printf("%s%s", add_space ? " " : "", rec->msg);
+}
+
+static int log_console_emit(struct log_device *ldev, struct log_rec *rec)
+{
+#if CONFIG_IS_ENABLED(LOG_CONSOLE_DEFER)
+	if (log_console_can_defer()) {
+		defer_capture = true;
+		log_console_show(rec);
+		defer_capture = false;
+
+		return 0;
+	}
+#endif
+	log_console_show(rec);
 
 	return 0;
 }
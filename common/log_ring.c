@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Log driver which keeps recent log records in memory
+ */
+
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <linux/kernel.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct log_ring_hdr - Header for a record in the ring buffer
+ *
+ * The file name, function name and message follow the header in the buffer,
+ * in that order, each with a nul terminator. The names are copied since they
+ * do not always live as long as the record, e.g. with 'log rec'.
+ *
+ * @line: Line number where the record was generated
+ * @cat: Category of the record
+ * @level: Level of the record
+ * @flags: Flags for the record (enum log_rec_flags)
+ * @file_len: Length of the file name including its terminator, 0 if none
+ * @func_len: Length of the function name including its terminator, 0 if none
+ * @len: Length of the message, including its nul terminator
+ */
+struct log_ring_hdr {
+	int line;
+	u16 cat;
+	u8 level;
+	u8 flags;
+	u8 file_len;
+	u8 func_len;
+	uint len;
+};
+
+/* Longest file or function name kept, including the nul terminator */
+#define LOG_RING_NAME_MAX	U8_MAX
+
+/*
+ * Records are stored one after the other, wrapping around at the end of the
+ * buffer. The buffer is allocated after relocation, so records generated
+ * before that are not kept. Since these variables are in .bss, they must not
+ * be looked at before relocation.
+ */
+static char *ring_buf;
+static uint ring_start;		/* offset of the oldest record */
+static uint ring_used;		/* number of bytes used by records */
+static uint ring_count;		/* number of records */
+static bool ring_failed;	/* could not allocate ring_buf */
+static bool ring_dumping;	/* records are being shown */
+
+static uint ring_next(uint pos, uint len)
+{
+	pos += len;
+	if (pos >= CONFIG_LOG_RING_SIZE)
+		pos -= CONFIG_LOG_RING_SIZE;
+
+	return pos;
+}
+
+static void ring_read(uint pos, void *dst, uint len)
+{
+	uint first = min(len, CONFIG_LOG_RING_SIZE - pos);
+
+	memcpy(dst, ring_buf + pos, first);
+	memcpy(dst + first, ring_buf, len - first);
+}
+
+static void ring_write(uint pos, const void *src, uint len)
+{
+	uint first = min(len, CONFIG_LOG_RING_SIZE - pos);
+
+	memcpy(ring_buf + pos, src, first);
+	memcpy(ring_buf, src + first, len - first);
+}
+
+/* write a string, truncated to @len - 1 characters, and its nul terminator */
+static uint ring_write_str(uint pos, const char *str, uint len)
+{
+	if (!len)
+		return pos;
+	ring_write(pos, str, len - 1);
+	pos = ring_next(pos, len - 1);
+	ring_write(pos, "", 1);
+
+	return ring_next(pos, 1);
+}
+
+/* read a string written by ring_write_str(), returning NULL if there is none */
+static const char *ring_read_str(uint pos, char *buf, uint len)
+{
+	if (!len)
+		return NULL;
+	ring_read(pos, buf, len);
+	buf[len - 1] = '\0';
+
+	return buf;
+}
+
+static uint ring_rec_size(const struct log_ring_hdr *hdr)
+{
+	return sizeof(*hdr) + hdr->file_len + hdr->func_len + hdr->len;
+}
+
+static uint ring_name_len(const char *name)
+{
+	return name ? min_t(uint, strlen(name) + 1, LOG_RING_NAME_MAX) : 0;
+}
+
+static void ring_drop_oldest(void)
+{
+	struct log_ring_hdr hdr;
+	uint len;
+
+	ring_read(ring_start, &hdr, sizeof(hdr));
+	len = ring_rec_size(&hdr);
+	ring_start = ring_next(ring_start, len);
+	ring_used -= len;
+	ring_count--;
+}
+
+static int log_ring_emit(struct log_device *ldev, struct log_rec *rec)
+{
+	struct log_ring_hdr hdr;
+	uint len, pos;
+
+	if (!(gd->flags & GD_FLG_RELOC))
+		return 0;
+	if (!ring_buf) {
+		if (ring_failed)
+			return 0;
+		ring_buf = malloc(CONFIG_LOG_RING_SIZE);
+		if (!ring_buf) {
+			ring_failed = true;
+			return -ENOMEM;
+		}
+	}
+	if (ring_dumping)
+		return 0;
+
+	hdr.line = rec->line;
+	hdr.cat = rec->cat;
+	hdr.level = rec->level;
+	hdr.flags = rec->flags;
+	hdr.file_len = ring_name_len(rec->file);
+	hdr.func_len = ring_name_len(rec->func);
+
+	/* truncate messages which are too large for the buffer */
+	len = CONFIG_LOG_RING_SIZE - sizeof(hdr) - hdr.file_len - hdr.func_len;
+	hdr.len = min_t(uint, strlen(rec->msg) + 1, len);
+	len = ring_rec_size(&hdr);
+	while (CONFIG_LOG_RING_SIZE - ring_used < len)
+		ring_drop_oldest();
+
+	pos = ring_next(ring_start, ring_used);
+	ring_write(pos, &hdr, sizeof(hdr));
+	pos = ring_next(pos, sizeof(hdr));
+	pos = ring_write_str(pos, rec->file, hdr.file_len);
+	pos = ring_write_str(pos, rec->func, hdr.func_len);
+	ring_write_str(pos, rec->msg, hdr.len);
+	ring_used += len;
+	ring_count++;
+
+	return 0;
+}
+
+int log_ring_dump(int count)
+{
+	struct log_driver *console = LOG_GET_DRIVER(console);
+	char file[LOG_RING_NAME_MAX], func[LOG_RING_NAME_MAX];
+	char msg[CONFIG_SYS_CBSIZE];
+	struct log_ring_hdr hdr;
+	struct log_rec rec;
+	uint pos, skip, i;
+
+	if (!(gd->flags & GD_FLG_RELOC) || !ring_buf)
+		return 0;
+
+	skip = count > 0 && count < ring_count ? ring_count - count : 0;
+	ring_dumping = true;
+	for (i = 0, pos = ring_start; i < ring_count; i++) {
+		ring_read(pos, &hdr, sizeof(hdr));
+		if (i >= skip) {
+			uint next = ring_next(pos, sizeof(hdr));
+
+			rec.cat = hdr.cat;
+			rec.level = hdr.level;
+			rec.flags = hdr.flags;
+			rec.file = ring_read_str(next, file, hdr.file_len);
+			next = ring_next(next, hdr.file_len);
+			rec.line = hdr.line;
+			rec.func = ring_read_str(next, func, hdr.func_len);
+			next = ring_next(next, hdr.func_len);
+			rec.msg = ring_read_str(next, msg,
+						min_t(uint, hdr.len, sizeof(msg)));
+			console->emit(NULL, &rec);
+		}
+		pos = ring_next(pos, ring_rec_size(&hdr));
+	}
+	ring_dumping = false;
+	log_console_flush();
+
+	return ring_count - skip;
+}
+
+LOG_DRIVER(ring) = {
+	.name	= "ring",
+	.emit	= log_ring_emit,
+	.flags	= LOGDF_ENABLE,
+};
@@ -320,8 +320,16 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 			return -EIO;
 		}
 		length = loadEnd - CONFIG_SYS_LOAD_ADDR;
-	} else {
-		memcpy(load_ptr, src, length);
+	} else if (src != load_ptr) {
+		/*
+		 * External data is normally read straight to its load address,
+		 * so only move it if it ended up somewhere else, e.g. due to
+		 * alignment or post-processing. The regions may overlap.
+		 *
+		 * Most memcpy() implementations return at once when source and
+		 * destination match, but the arm64 assembler one does not.
+		 */
+		memmove(load_ptr, src, length);
 	}
 
 	if (image_info) {
@@ -974,8 +974,12 @@ static void usb_stor_set_max_xfer_blk(struct usb_device *udev,
 	 * Windows 7 limiting transfers to 128 sectors for both USB2 and USB3
 	 * and Apple Mac OS X 10.11 limiting transfers to 256 sectors for USB2
 	 * and 2048 for USB3 devices.
+	 *
+	 * SuperSpeed devices are not constrained by this history and the
+	 * per-command overhead dominates with small transfers, so follow
+	 * Linux and Mac OS X and allow 2048 sectors for these.
 	 */
-	unsigned short blk = 240;
+	unsigned short blk = udev->speed >= USB_SPEED_SUPER ? 2048 : 240;
 
 #if CONFIG_IS_ENABLED(DM_USB)
 	size_t size;
@@ -1520,6 +1524,12 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 	dev_desc->blksz = blksz;
 	dev_desc->log2blksz = LOG2(dev_desc->blksz);
 	dev_desc->type = perq;
+
+	/* The transfer limit is in 512-byte sectors; convert it to blocks */
+	usb_stor_set_max_xfer_blk(dev, ss);
+	if (blksz > 512)
+		ss->max_xfer_blk = max_t(uint, ss->max_xfer_blk / (blksz / 512),
+					 1);
 	debug(" address %d\n", dev_desc->target);
 
 	return 1;
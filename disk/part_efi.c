@@ -62,6 +62,21 @@ static int is_pte_valid(gpt_entry * pte);
 static int find_valid_gpt(struct blk_desc *desc, gpt_header *gpt_head,
 			  gpt_entry **pgpt_pte);
 
+/**
+ * struct gpt_cache - GPT last found by find_valid_gpt()
+ *
+ * @desc:	Block device the GPT was read from, or NULL if none
+ * @head:	GPT header
+ * @pte:	Partition table entries
+ * @pte_size:	Size of @pte in bytes
+ */
+static struct gpt_cache {
+	struct blk_desc *desc;
+	gpt_header head;
+	gpt_entry *pte;
+	size_t pte_size;
+} gpt_cache;
+
 static char *print_efiname(gpt_entry *pte)
 {
 	static char name[PARTNAME_SZ + 1];
@@ -1073,6 +1088,73 @@ static int is_gpt_valid(struct blk_desc *desc, u64 lba, gpt_header *pgpt_head,
 	return 1;
 }
 
+void gpt_cache_invalidate(struct blk_desc *desc)
+{
+	if (gpt_cache.desc != desc)
+		return;
+	free(gpt_cache.pte);
+	gpt_cache.pte = NULL;
+	gpt_cache.desc = NULL;
+}
+
+/**
+ * gpt_cache_store() - Remember a valid GPT for later lookups
+ *
+ * @desc:	Block device the GPT was read from
+ * @gpt_head:	Valid GPT header
+ * @gpt_pte:	Valid PTEs for @gpt_head
+ */
+static void gpt_cache_store(struct blk_desc *desc, gpt_header *gpt_head,
+			    gpt_entry *gpt_pte)
+{
+	size_t size = le32_to_cpu(gpt_head->num_partition_entries) *
+		      le32_to_cpu(gpt_head->sizeof_partition_entry);
+
+	gpt_cache_invalidate(gpt_cache.desc);
+	gpt_cache.pte = malloc(size);
+	if (!gpt_cache.pte)
+		return;
+	memcpy(gpt_cache.pte, gpt_pte, size);
+	memcpy(&gpt_cache.head, gpt_head, sizeof(gpt_cache.head));
+	gpt_cache.pte_size = size;
+	gpt_cache.desc = desc;
+}
+
+/**
+ * gpt_cache_lookup() - Use the cached GPT if it is still current
+ *
+ * The GPT header is read again and compared with the cached one. Since it
+ * holds the CRC32 of the partition entries, they need not be read unless the
+ * header has changed.
+ *
+ * @desc:	Block device to look up
+ * @gpt_head:	Returns the GPT header
+ * @pgpt_pte:	Returns a copy of the PTEs, which the caller must free
+ * Return:	true if the cached GPT was used, false if it must be read
+ */
+static bool gpt_cache_lookup(struct blk_desc *desc, gpt_header *gpt_head,
+			     gpt_entry **pgpt_pte)
+{
+	gpt_entry *pte;
+
+	if (!desc || gpt_cache.desc != desc)
+		return false;
+
+	if (blk_dread(desc, (lbaint_t)le64_to_cpu(gpt_cache.head.my_lba), 1,
+		      gpt_head) != 1 ||
+	    memcmp(gpt_head, &gpt_cache.head, sizeof(gpt_cache.head)))
+		return false;
+
+	pte = memalign(ARCH_DMA_MINALIGN,
+		       PAD_TO_BLOCKSIZE(gpt_cache.pte_size, desc));
+	if (!pte)
+		return false;
+	memcpy(pte, gpt_cache.pte, gpt_cache.pte_size);
+	*pgpt_pte = pte;
+
+	return true;
+}
+
 /**
  * find_valid_gpt() - finds a valid GPT header and PTEs
  *
@@ -1087,6 +1169,9 @@ static int find_valid_gpt(struct blk_desc *desc, gpt_header *gpt_head,
 {
 	int r;
 
+	if (gpt_cache_lookup(desc, gpt_head, pgpt_pte))
+		return 1;
+
 	r = is_gpt_valid(desc, GPT_PRIMARY_PARTITION_TABLE_LBA, gpt_head,
 			 pgpt_pte);
 
@@ -1102,6 +1187,8 @@ static int find_valid_gpt(struct blk_desc *desc, gpt_header *gpt_head,
 		if (r != 2)
 			log_debug("        Using Backup GPT\n");
 	}
+	gpt_cache_store(desc, gpt_head, *pgpt_pte);
+
 	return 1;
 }
 
@@ -52,6 +52,8 @@ static int ata_io_flush(struct ahci_uc_priv *uc_priv, u8 port);
 #define WAIT_MS_LINKUP	200
 
 #define AHCI_CAP_S64A BIT(31)
+#define AHCI_CAP_SNCQ BIT(30)
+#define AHCI_CAP_NCS(cap)	((((cap) >> 8) & 0x1f) + 1)
 
 __weak void __iomem *ahci_port_base(void __iomem *base, u32 port)
 {
@@ -385,11 +387,19 @@ static int ahci_init_one(struct ahci_uc_priv *uc_priv, struct udevice *dev)
 
 #define MAX_DATA_BYTE_COUNT  (4*1024*1024)
 
-static int ahci_fill_sg(struct ahci_uc_priv *uc_priv, u8 port,
+/*
+ * Each queued command has its own command table, with room for enough PRD
+ * entries to cover MAX_SATA_BLOCKS_READ_WRITE blocks. Tables must be aligned
+ * to 128 bytes.
+ */
+#define AHCI_NCQ_SG	DIV_ROUND_UP(MAX_SATA_BLOCKS_READ_WRITE * ATA_SECT_SIZE, \
+				     MAX_DATA_BYTE_COUNT)
+#define AHCI_NCQ_TBL_SZ	ALIGN(AHCI_CMD_TBL_HDR + AHCI_NCQ_SG * \
+			      sizeof(struct ahci_sg), 128)
+
+static int ahci_fill_sg(struct ahci_uc_priv *uc_priv, struct ahci_sg *ahci_sg,
 			unsigned char *buf, int buf_len)
 {
-	struct ahci_ioports *pp = &(uc_priv->port[port]);
-	struct ahci_sg *ahci_sg = pp->cmd_tbl_sg;
 	phys_addr_t pa = virt_to_phys(buf);
 	u32 sg_count;
 	int i;
@@ -419,18 +429,23 @@ static int ahci_fill_sg(struct ahci_uc_priv *uc_priv, u8 port,
 	return sg_count;
 }
 
-static void ahci_fill_cmd_slot(struct ahci_ioports *pp, u32 opts)
+static void ahci_fill_cmd_hdr(struct ahci_cmd_hdr *cmd_slot, ulong tbl, u32 opts)
 {
-	phys_addr_t pa = virt_to_phys((void *)pp->cmd_tbl);
+	phys_addr_t pa = virt_to_phys((void *)tbl);
 
-	pp->cmd_slot->opts = cpu_to_le32(opts);
-	pp->cmd_slot->status = 0;
-	pp->cmd_slot->tbl_addr = cpu_to_le32(lower_32_bits(pa));
+	cmd_slot->opts = cpu_to_le32(opts);
+	cmd_slot->status = 0;
+	cmd_slot->tbl_addr = cpu_to_le32(lower_32_bits(pa));
 #ifdef CONFIG_PHYS_64BIT
-	pp->cmd_slot->tbl_addr_hi = cpu_to_le32(upper_32_bits(pa));
+	cmd_slot->tbl_addr_hi = cpu_to_le32(upper_32_bits(pa));
 #endif
 }
 
+static void ahci_fill_cmd_slot(struct ahci_ioports *pp, u32 opts)
+{
+	ahci_fill_cmd_hdr(pp->cmd_slot, pp->cmd_tbl, opts);
+}
+
 static int wait_spinup(void __iomem *port_mmio)
 {
 	ulong start;
@@ -477,7 +492,7 @@ static int ahci_port_start(struct ahci_uc_priv *uc_priv, u8 port)
 	pp->cmd_slot =
 		(struct ahci_cmd_hdr *)(uintptr_t)virt_to_phys((void *)mem);
 	debug("cmd_slot = %p\n", pp->cmd_slot);
-	mem += (AHCI_CMD_SLOT_SZ + 224);
+	mem += AHCI_CMD_SLOT_SZ * AHCI_MAX_CMD_SLOT;
 
 	/*
 	 * Second item: Received-FIS area
@@ -546,7 +561,7 @@ static int ahci_device_data_io(struct ahci_uc_priv *uc_priv, u8 port, u8 *fis,
 
 	memcpy((unsigned char *)pp->cmd_tbl, fis, fis_len);
 
-	sg_count = ahci_fill_sg(uc_priv, port, buf, buf_len);
+	sg_count = ahci_fill_sg(uc_priv, pp->cmd_tbl_sg, buf, buf_len);
 	opts = (fis_len >> 2) | (sg_count << 16) | (is_write << 6);
 	ahci_fill_cmd_slot(pp, opts);
 
@@ -569,6 +584,183 @@ static int ahci_device_data_io(struct ahci_uc_priv *uc_priv, u8 port, u8 *fis,
 	return 0;
 }
 
+/**
+ * ahci_ncq_setup() - Work out whether a port can use native command queueing
+ *
+ * The queue depth is limited by both the controller and the drive. Each queued
+ * command needs its own command table, so allocate a pool of these the first
+ * time around.
+ *
+ * @uc_priv: Controller
+ * @port: Port number, whose ataid[] must be valid
+ */
+static void ahci_ncq_setup(struct ahci_uc_priv *uc_priv, u8 port)
+{
+	struct ahci_ioports *pp = &uc_priv->port[port];
+	u16 *id = uc_priv->ataid[port];
+	void *mem;
+
+	pp->ncq_depth = 0;
+	if (!IS_ENABLED(CONFIG_AHCI_NCQ) || !(uc_priv->cap & AHCI_CAP_SNCQ) ||
+	    !ata_id_has_ncq(id))
+		return;
+
+	if (!pp->ncq_tbl) {
+		mem = memalign(max(128, ARCH_DMA_MINALIGN),
+			       AHCI_MAX_CMD_SLOT * AHCI_NCQ_TBL_SZ);
+		if (!mem) {
+			debug("%s: No mem for queued commands\n", __func__);
+			return;
+		}
+		memset(mem, '\0', AHCI_MAX_CMD_SLOT * AHCI_NCQ_TBL_SZ);
+		pp->ncq_tbl = virt_to_phys(mem);
+	}
+
+	pp->ncq_depth = min_t(uint, AHCI_CAP_NCS(uc_priv->cap),
+			      (id[ATA_ID_QUEUE_DEPTH] & 0x1f) + 1);
+	debug("Port %d: NCQ depth %d\n", port, pp->ncq_depth);
+}
+
+/**
+ * ahci_ncq_recover() - Get a port going again after a queued command failed
+ *
+ * The controller stops processing the command list when a queued command gets
+ * an error. Stopping the port drops any commands which are still outstanding
+ * so that it can be restarted.
+ *
+ * This does not read the NCQ error log, so the drive may still be unhappy
+ * with queued commands. Turn NCQ off for the port so that the caller falls
+ * back to non-queued commands from now on.
+ *
+ * @pp: Port to recover
+ */
+static void ahci_ncq_recover(struct ahci_ioports *pp)
+{
+	void __iomem *port_mmio = pp->port_mmio;
+	u32 cmd = readl(port_mmio + PORT_CMD);
+
+	printf("scsi_ahci: Disabling NCQ\n");
+	pp->ncq_depth = 0;
+
+	writel_with_flush(cmd & ~PORT_CMD_START, port_mmio + PORT_CMD);
+	if (waiting_for_cmd_completed(port_mmio + PORT_CMD, WAIT_MS_FLUSH,
+				      PORT_CMD_LIST_ON))
+		debug("Port did not stop\n");
+	writel(readl(port_mmio + PORT_SCR_ERR), port_mmio + PORT_SCR_ERR);
+	writel(readl(port_mmio + PORT_IRQ_STAT), port_mmio + PORT_IRQ_STAT);
+	writel_with_flush(cmd | PORT_CMD_START, port_mmio + PORT_CMD);
+}
+
+/**
+ * ahci_ncq_data_io() - Read or write using native command queueing
+ *
+ * The transfer is split into READ/WRITE FPDMA QUEUED commands of up to
+ * MAX_SATA_BLOCKS_READ_WRITE blocks. Up to ncq_depth of these are issued at
+ * once, which lets the drive work on the next command while the previous one
+ * is being transferred, rather than waiting for a round trip each time.
+ *
+ * @uc_priv: Controller
+ * @port: Port number
+ * @lba: First block to transfer
+ * @blocks: Number of blocks to transfer
+ * @buf: Data buffer
+ * @is_write: true to write, false to read
+ * Return: 0 if OK, -EIO on error
+ */
+static int ahci_ncq_data_io(struct ahci_uc_priv *uc_priv, u8 port,
+			    lbaint_t lba, u32 blocks, u8 *buf, bool is_write)
+{
+	struct ahci_ioports *pp = &uc_priv->port[port];
+	void __iomem *port_mmio = pp->port_mmio;
+	ulong buf_len = blocks * ATA_SECT_SIZE;
+	ulong start;
+	u8 *ptr = buf;
+	u32 mask, stat;
+	int tag;
+
+	if ((readl(port_mmio + PORT_SCR_STAT) & 0xf) != 0x03) {
+		debug("No Link on port %d!\n", port);
+		return -EIO;
+	}
+
+	ahci_dcache_flush_range((ulong)buf, buf_len);
+	writel(readl(port_mmio + PORT_IRQ_STAT), port_mmio + PORT_IRQ_STAT);
+
+	while (blocks) {
+		mask = 0;
+		for (tag = 0; tag < pp->ncq_depth && blocks; tag++) {
+			u32 now_blocks = min_t(u32, MAX_SATA_BLOCKS_READ_WRITE,
+					       blocks);
+			ulong tbl = pp->ncq_tbl + tag * AHCI_NCQ_TBL_SZ;
+			u8 *fis = (u8 *)tbl;
+			int sg_count;
+
+			memset(fis, '\0', 20);
+			fis[0] = 0x27;		/* Host to device FIS */
+			fis[1] = 1 << 7;	/* Command FIS */
+			fis[2] = is_write ? ATA_CMD_FPDMA_WRITE :
+				 ATA_CMD_FPDMA_READ;
+			/* The sector count goes in the features registers */
+			fis[3] = now_blocks & 0xff;
+			fis[4] = lba & 0xff;
+			fis[5] = (lba >> 8) & 0xff;
+			fis[6] = (lba >> 16) & 0xff;
+			fis[7] = 1 << 6;	/* device reg: set LBA mode */
+			fis[8] = (lba >> 24) & 0xff;
+#ifdef CONFIG_SYS_64BIT_LBA
+			fis[9] = (lba >> 32) & 0xff;
+			fis[10] = (lba >> 40) & 0xff;
+#endif
+			fis[11] = (now_blocks >> 8) & 0xff;
+			fis[12] = tag << 3;
+
+			sg_count = ahci_fill_sg(uc_priv, (struct ahci_sg *)
+						(tbl + AHCI_CMD_TBL_HDR), ptr,
+						now_blocks * ATA_SECT_SIZE);
+			if (sg_count < 0)
+				return -EIO;
+			ahci_fill_cmd_hdr(&pp->cmd_slot[tag], tbl,
+					  5 | (sg_count << 16) | (is_write << 6));
+
+			mask |= BIT(tag);
+			ptr += now_blocks * ATA_SECT_SIZE;
+			lba += now_blocks;
+			blocks -= now_blocks;
+		}
+
+		ahci_dcache_flush_range((ulong)pp->cmd_slot,
+					ALIGN(tag * AHCI_CMD_SLOT_SZ,
+					      ARCH_DMA_MINALIGN));
+		ahci_dcache_flush_range(pp->ncq_tbl,
+					ALIGN(tag * AHCI_NCQ_TBL_SZ,
+					      ARCH_DMA_MINALIGN));
+
+		writel(mask, port_mmio + PORT_SCR_ACT);
+		writel_with_flush(mask, port_mmio + PORT_CMD_ISSUE);
+
+		start = get_timer(0);
+		while ((readl(port_mmio + PORT_SCR_ACT) |
+			readl(port_mmio + PORT_CMD_ISSUE)) & mask) {
+			stat = readl(port_mmio + PORT_IRQ_STAT);
+			if (stat & (PORT_IRQ_FATAL)) {
+				printf("scsi_ahci: Queued %s failed (status %x)\n",
+				       is_write ? "write" : "read", stat);
+				ahci_ncq_recover(pp);
+				return -EIO;
+			}
+			if (get_timer(start) > WAIT_MS_DATAIO) {
+				printf("timeout exit!\n");
+				ahci_ncq_recover(pp);
+				return -EIO;
+			}
+		}
+	}
+
+	ahci_dcache_invalidate_range((ulong)buf, buf_len);
+
+	return 0;
+}
+
 static char *ata_id_strcpy(u16 *target, u16 *src, int len)
 {
 	int i;
@@ -636,6 +828,7 @@ static int ata_scsiop_inquiry(struct ahci_uc_priv *uc_priv,
 
 	memcpy(idbuf, tmpid, ATA_ID_WORDS * 2);
 	ata_swap_buf_le16(idbuf, ATA_ID_WORDS);
+	ahci_ncq_setup(uc_priv, port);
 
 	memcpy(&pccb->pdata[8], "ATA     ", 8);
 	ata_id_strcpy((u16 *)&pccb->pdata[16], &idbuf[ATA_ID_PROD], 16);
@@ -689,6 +882,19 @@ static int ata_scsiop_read_write(struct ahci_uc_priv *uc_priv,
 	debug("scsi_ahci: %s %u blocks starting from lba 0x" LBAFU "\n",
 	      is_write ?  "write" : "read", blocks, lba);
 
+	if (uc_priv->port[pccb->target].ncq_depth) {
+		if (ATA_SECT_SIZE * blocks > user_buffer_size) {
+			printf("scsi_ahci: Error: buffer too small.\n");
+			return -EIO;
+		}
+		if (!ahci_ncq_data_io(uc_priv, pccb->target, lba, blocks,
+				      user_buffer, is_write))
+			blocks = 0;
+		/* If NCQ was turned off, retry without it */
+		else if (uc_priv->port[pccb->target].ncq_depth)
+			return -EIO;
+	}
+
 	/* Preset the FIS */
 	memset(fis, 0, sizeof(fis));
 	fis[0] = 0x27;		 /* Host to device FIS. */
@@ -740,22 +946,23 @@ static int ata_scsiop_read_write(struct ahci_uc_priv *uc_priv,
 			return -EIO;
 		}
 
-		/* If this transaction is a write, do a following flush.
-		 * Writes in u-boot are so rare, and the logic to know when is
-		 * the last write and do a flush only there is sufficiently
-		 * difficult. Just do a flush after every write. This incurs,
-		 * usually, one extra flush when the rare writes do happen.
-		 */
-		if (is_write) {
-			if (-EIO == ata_io_flush(uc_priv, pccb->target))
-				return -EIO;
-		}
 		user_buffer += transfer_size;
 		user_buffer_size -= transfer_size;
 		blocks -= now_blocks;
 		lba += now_blocks;
 	}
 
+	/* If this transaction is a write, do a following flush.
+	 * Writes in u-boot are so rare, and the logic to know when is
+	 * the last write and do a flush only there is sufficiently
+	 * difficult. Just do a flush after every write. This incurs,
+	 * usually, one extra flush when the rare writes do happen.
+	 */
+	if (is_write) {
+		if (-EIO == ata_io_flush(uc_priv, pccb->target))
+			return -EIO;
+	}
+
 	return 0;
 }
 
@@ -52,6 +52,22 @@ tested on both gig copper and gig fiber boards
 /* Intel i210 needs the DMA descriptor rings aligned to 128b */
 #define E1000_BUFFER_ALIGN	128
 
+/*
+ * Number of receive descriptors, each with its own buffer. The buffer size
+ * matches the 2048-byte setting in RCTL.
+ */
+#define E1000_RX_DESC_COUNT	16
+#define E1000_RX_BUF_SIZE	2048
+
+/*
+ * Receive descriptors are handed back to the hardware a cache line at a time.
+ * Otherwise flushing a descriptor from the cache could overwrite the status
+ * that the hardware has just written to another one in the same line.
+ */
+#define E1000_RX_DESC_BATCH	\
+	(ARCH_DMA_MINALIGN > sizeof(struct e1000_rx_desc) ? \
+	 ARCH_DMA_MINALIGN / sizeof(struct e1000_rx_desc) : 1)
+
 /*
  * TODO(sjg@chromium.org): Even with driver model we share these buffers.
  * Concurrent receiving on multiple active Ethernet devices will not work.
@@ -59,8 +75,10 @@ tested on both gig copper and gig fiber boards
  * move these buffers and the tx/rx pointers to struct e1000_hw.
  */
 DEFINE_ALIGN_BUFFER(struct e1000_tx_desc, tx_base, 16, E1000_BUFFER_ALIGN);
-DEFINE_ALIGN_BUFFER(struct e1000_rx_desc, rx_base, 16, E1000_BUFFER_ALIGN);
-DEFINE_ALIGN_BUFFER(unsigned char, packet, 4096, E1000_BUFFER_ALIGN);
+DEFINE_ALIGN_BUFFER(struct e1000_rx_desc, rx_base, E1000_RX_DESC_COUNT,
+		    E1000_BUFFER_ALIGN);
+DEFINE_ALIGN_BUFFER(unsigned char, rx_buf,
+		    E1000_RX_DESC_COUNT * E1000_RX_BUF_SIZE, E1000_BUFFER_ALIGN);
 
 static int tx_tail;
 static int rx_tail, rx_last;
@@ -5099,29 +5117,45 @@ e1000_sw_init(struct e1000_hw *hw)
 	return E1000_SUCCESS;
 }
 
-void
-fill_rx(struct e1000_hw *hw)
+/**
+ * fill_rx() - Give receive descriptors to the hardware
+ *
+ * This sets up @count descriptors starting at rx_tail, each pointing to its
+ * own buffer, and moves the hardware's tail pointer past them
+ *
+ * @hw: Hardware to update
+ * @count: Number of descriptors, a multiple of E1000_RX_DESC_BATCH
+ */
+static void fill_rx(struct e1000_hw *hw, int count)
 {
 	struct e1000_rx_desc *rd;
 	unsigned long flush_start, flush_end;
+	uchar *buf;
+	int i;
 
-	rx_last = rx_tail;
-	rd = rx_base + rx_tail;
-	rx_tail = (rx_tail + 1) % 8;
-	memset(rd, 0, 16);
-	rd->buffer_addr = cpu_to_le64(virt_to_phys(packet));
-
-	/*
-	 * Make sure there are no stale data in WB over this area, which
-	 * might get written into the memory while the e1000 also writes
-	 * into the same memory area.
-	 */
-	invalidate_dcache_range((unsigned long)packet,
-				(unsigned long)packet + 4096);
-	/* Dump the DMA descriptor into RAM. */
-	flush_start = ((unsigned long)rd) & ~(ARCH_DMA_MINALIGN - 1);
-	flush_end = flush_start + roundup(sizeof(*rd), ARCH_DMA_MINALIGN);
-	flush_dcache_range(flush_start, flush_end);
+	for (i = 0; i < count; i++) {
+		rd = rx_base + rx_tail;
+		buf = rx_buf + rx_tail * E1000_RX_BUF_SIZE;
+		memset(rd, 0, sizeof(*rd));
+		rd->buffer_addr = cpu_to_le64(virt_to_phys(buf));
+
+		/*
+		 * Make sure there are no stale data in WB over this area, which
+		 * might get written into the memory while the e1000 also writes
+		 * into the same memory area.
+		 */
+		invalidate_dcache_range((unsigned long)buf,
+					(unsigned long)buf + E1000_RX_BUF_SIZE);
+
+		/* Dump the DMA descriptors into RAM, a cache line at a time */
+		rx_tail = (rx_tail + 1) % E1000_RX_DESC_COUNT;
+		if (!(rx_tail % E1000_RX_DESC_BATCH)) {
+			rd -= E1000_RX_DESC_BATCH - 1;
+			flush_start = (unsigned long)rd;
+			flush_end = (unsigned long)(rd + E1000_RX_DESC_BATCH);
+			flush_dcache_range(flush_start, flush_end);
+		}
+	}
 
 	E1000_WRITE_REG(hw, RDT, rx_tail);
 }
@@ -5261,6 +5295,7 @@ e1000_configure_rx(struct e1000_hw *hw)
 {
 	unsigned long rctl, ctrl_ext;
 	rx_tail = 0;
+	rx_last = 0;
 
 	/* make sure receives are disabled while setting up the descriptors */
 	rctl = E1000_READ_REG(hw, RCTL);
@@ -5284,7 +5319,8 @@ e1000_configure_rx(struct e1000_hw *hw)
 	E1000_WRITE_REG(hw, RDBAL, lower_32_bits(virt_to_phys(rx_base)));
 	E1000_WRITE_REG(hw, RDBAH, upper_32_bits(virt_to_phys(rx_base)));
 
-	E1000_WRITE_REG(hw, RDLEN, 128);
+	E1000_WRITE_REG(hw, RDLEN,
+			E1000_RX_DESC_COUNT * sizeof(struct e1000_rx_desc));
 
 	/* Setup the HW Rx Head and Tail Descriptor Pointers */
 	E1000_WRITE_REG(hw, RDH, 0);
@@ -5301,7 +5337,12 @@ e1000_configure_rx(struct e1000_hw *hw)
 
 	E1000_WRITE_REG(hw, RCTL, rctl);
 
-	fill_rx(hw);
+	/*
+	 * Keep one batch of descriptors back, so the hardware does not see a
+	 * full ring as an empty one
+	 */
+	BUILD_BUG_ON(E1000_RX_DESC_COUNT < 2 * E1000_RX_DESC_BATCH);
+	fill_rx(hw, E1000_RX_DESC_COUNT - E1000_RX_DESC_BATCH);
 }
 
 /**************************************************************************
@@ -5310,6 +5351,7 @@ POLL - Wait for a frame
 static int
 _e1000_poll(struct e1000_hw *hw)
 {
+	uchar *packet = rx_buf + rx_last * E1000_RX_BUF_SIZE;
 	struct e1000_rx_desc *rd;
 	unsigned long inval_start, inval_end;
 	uint32_t len;
@@ -5675,7 +5717,7 @@ static int e1000_eth_recv(struct udevice *dev, int flags, uchar **packetp)
 
 	len = _e1000_poll(hw);
 	if (len)
-		*packetp = packet;
+		*packetp = rx_buf + rx_last * E1000_RX_BUF_SIZE;
 
 	return len ? len : -EAGAIN;
 }
@@ -5684,7 +5726,14 @@ static int e1000_free_pkt(struct udevice *dev, uchar *packet, int length)
 {
 	struct e1000_hw *hw = dev_get_priv(dev);
 
-	fill_rx(hw);
+	/*
+	 * Once all the packets in a batch have been processed, the batch
+	 * before this one can go back to the hardware. Its buffers are free
+	 * and the hardware has finished writing to its descriptors.
+	 */
+	rx_last = (rx_last + 1) % E1000_RX_DESC_COUNT;
+	if (!(rx_last % E1000_RX_DESC_BATCH))
+		fill_rx(hw, E1000_RX_DESC_BATCH);
 
 	return 0;
 }
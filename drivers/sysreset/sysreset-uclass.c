@@ -61,6 +61,8 @@ int sysreset_walk(enum sysreset_t type)
 		for (uclass_first_device(UCLASS_SYSRESET, &dev);
 		     dev;
 		     uclass_next_device(&dev)) {
+			/* deferred log output is lost on reset */
+			log_console_flush();
 			ret = sysreset_request(dev, type);
 			if (ret == -EINPROGRESS)
 				break;
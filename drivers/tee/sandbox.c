@@ -294,6 +294,9 @@ static u32 ta_avb_invoke_func(struct udevice *dev, u32 func, uint num_params,
 		hsearch_r(e, ENV_FIND, &ep, &state->pstorage_htab, 0);
 		if (ep)
 			hdelete_r(e.key, &state->pstorage_htab, 0);
+		/* the table grows as needed, so enforce the limit here */
+		else if (state->pstorage_htab.filled >= pstorage_max)
+			return TEE_ERROR_OUT_OF_MEMORY;
 
 		e.key = name;
 		e.data = value;
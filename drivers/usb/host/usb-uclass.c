@@ -172,6 +172,12 @@ int usb_get_max_xfer_size(struct usb_device *udev, size_t *size)
 	return ops->get_max_xfer_size(bus, size);
 }
 
+/* Number of controllers set up by usb_init_controllers(), -1 if not called */
+static int controllers_initialized = -1;
+
+/* true if usb_init_controllers() started at least one controller */
+static bool controllers_started;
+
 int usb_stop(void)
 {
 	struct udevice *bus;
@@ -217,6 +223,7 @@ int usb_stop(void)
 	}
 	uc_priv->companion_device_count = 0;
 	usb_started = 0;
+	controllers_initialized = -1;
 
 	return err;
 }
@@ -287,23 +294,21 @@ static int usb_probe_companion(struct udevice *bus)
 	return 0;
 }
 
-int usb_init(void)
+int usb_init_controllers(void)
 {
-	int controllers_initialized = 0;
-	struct usb_uclass_priv *uc_priv;
-	struct usb_bus_priv *priv;
 	struct udevice *bus;
 	struct uclass *uc;
 	int ret;
 
-	asynch_allowed = 1;
+	if (controllers_initialized >= 0)
+		return 0;
 
 	ret = uclass_get(UCLASS_USB, &uc);
 	if (ret)
 		return ret;
 
-	uc_priv = uclass_get_priv(uc);
-
+	controllers_initialized = 0;
+	controllers_started = false;
 	uclass_foreach_dev(bus, uc) {
 		/* init low_level USB */
 		printf("Bus %s: ", bus->name);
@@ -343,9 +348,33 @@ int usb_init(void)
 			continue;
 
 		controllers_initialized++;
-		usb_started = true;
+		controllers_started = true;
 	}
 
+	return 0;
+}
+
+int usb_init(void)
+{
+	struct usb_uclass_priv *uc_priv;
+	struct usb_bus_priv *priv;
+	struct udevice *bus;
+	struct uclass *uc;
+	int ret;
+
+	asynch_allowed = 1;
+
+	ret = usb_init_controllers();
+	if (ret)
+		return ret;
+
+	ret = uclass_get(UCLASS_USB, &uc);
+	if (ret)
+		return ret;
+
+	uc_priv = uclass_get_priv(uc);
+	usb_started = controllers_started;
+
 	/*
 	 * lowlevel init done, now scan the bus for devices i.e. search HUBs
 	 * and configure them, first scan primary controllers.
@@ -388,6 +417,7 @@ int usb_init(void)
 	/* if we were not able to find at least one working bus, bail out */
 	if (controllers_initialized == 0)
 		printf("No working controllers found\n");
+	controllers_initialized = -1;
 
 	return usb_started ? 0 : -ENOENT;
 }
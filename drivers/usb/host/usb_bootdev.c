@@ -27,6 +27,14 @@ static int usb_bootdev_hunt(struct bootdev_hunter *info, bool show)
 	return usb_init();
 }
 
+static int usb_bootdev_start(struct bootdev_hunter *info, bool show)
+{
+	if (!CONFIG_IS_ENABLED(DM_USB) || usb_started)
+		return 0;
+
+	return usb_init_controllers();
+}
+
 struct bootdev_ops usb_bootdev_ops = {
 };
 
@@ -47,5 +55,6 @@ BOOTDEV_HUNTER(usb_bootdev_hunter) = {
 	.prio		= BOOTDEVP_5_SCAN_SLOW,
 	.uclass		= UCLASS_USB,
 	.hunt		= usb_bootdev_hunt,
+	.start		= usb_bootdev_start,
 	.drv		= DM_DRIVER_REF(usb_bootdev),
 };
@@ -108,6 +108,7 @@ static int console_set_cursor_visible(struct udevice *dev, bool visible,
 	struct video_fontdata *fontdata = priv->fontdata;
 	int pbytes = VNBYTES(vid_priv->bpix);
 	void *start, *line;
+	int ret;
 
 	/* for now, this is not used outside expo */
 	if (!IS_ENABLED(CONFIG_EXPO))
@@ -120,10 +121,12 @@ static int console_set_cursor_visible(struct udevice *dev, bool visible,
 	x -= 1;
 
 	line = start;
-	draw_cursor_vertically(&line, vid_priv, vc_priv->y_charsize,
-			       NORMAL_DIRECTION);
+	ret = draw_cursor_vertically(&line, vid_priv, vc_priv->y_charsize,
+				     NORMAL_DIRECTION);
+	if (ret)
+		return ret;
 
-	return 0;
+	return vidconsole_sync_copy(dev, start, line);
 }
 
 struct vidconsole_ops console_ops = {
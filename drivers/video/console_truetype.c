@@ -127,6 +127,63 @@ struct pos_info {
  */
 #define POS_HISTORY_SIZE	(CONFIG_SYS_CBSIZE * 11 / 10)
 
+/* Number of characters for which the glyph index and advance are cached */
+#define TT_CACHED_CHARS		128
+
+/* Number of rendered glyphs cached for each font / size (avoids divide by 0) */
+#define TT_GLYPH_SLOTS		max(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE, 1)
+
+/**
+ * struct console_tt_char - Cached information about a character
+ *
+ * @glyph:	Glyph index of the character in the font, or -1 if not known yet
+ * @advance:	Advance width of the character, in font units
+ */
+struct console_tt_char {
+	int glyph;
+	int advance;
+};
+
+/**
+ * struct console_tt_glyph - A rendered glyph
+ *
+ * The bitmap depends on the sub-pixel position at which the glyph is drawn, so
+ * this is part of the key. Glyphs with no pixels (such as space) are cached
+ * with a NULL @data.
+ *
+ * @glyph:	Glyph index in the font, or -1 if this entry is empty
+ * @shift:	Horizontal sub-pixel shift passed to the renderer
+ * @width:	Width of the bitmap in pixels
+ * @height:	Height of the bitmap in pixels
+ * @xoff:	X offset of the bitmap from the cursor position
+ * @yoff:	Y offset of the bitmap from the baseline
+ * @data:	8-bit-per-pixel bitmap, or NULL if the glyph is empty
+ */
+struct console_tt_glyph {
+	int glyph;
+	float shift;
+	short width;
+	short height;
+	short xoff;
+	short yoff;
+	u8 *data;
+};
+
+/**
+ * struct console_tt_cache - Cache of rendered glyphs for a font / size
+ *
+ * Rendering a glyph with the STB library is slow, particularly on platforms
+ * which use soft-float, so glyphs are kept once they have been rendered. The
+ * glyph cache is direct-mapped: a new glyph replaces whatever is in its slot.
+ *
+ * @chars:	Glyph index and advance for the first TT_CACHED_CHARS characters
+ * @glyphs:	Rendered glyphs
+ */
+struct console_tt_cache {
+	struct console_tt_char chars[TT_CACHED_CHARS];
+	struct console_tt_glyph glyphs[CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE];
+};
+
 /**
  * struct console_tt_metrics - Information about a font / size combination
  *
@@ -145,6 +202,7 @@ struct pos_info {
  * @scale:	Scale of the font. This is calculated from the pixel height
  *		of the font. It is used by the STB library to generate images
  *		of the correct size.
+ * @cache:	Glyph cache for this font / size, or NULL if not allocated yet
  */
 struct console_tt_metrics {
 	const char *font_name;
@@ -153,6 +211,7 @@ struct console_tt_metrics {
 	stbtt_fontinfo font;
 	int baseline;
 	double scale;
+	struct console_tt_cache *cache;
 };
 
 /**
@@ -261,6 +320,242 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(UNIT_TEST)
+static bool tt_cache_disabled;
+
+void console_truetype_set_cache(bool enable)
+{
+	tt_cache_disabled = !enable;
+}
+#else
+#define tt_cache_disabled	false
+#endif
+
+/**
+ * tt_get_cache() - Get the glyph cache for a font / size
+ *
+ * The cache is allocated the first time it is needed
+ *
+ * @met:	Metrics to check
+ * Return: cache, or NULL if the glyph cache is disabled or out of memory
+ */
+static struct console_tt_cache *tt_get_cache(struct console_tt_metrics *met)
+{
+	struct console_tt_cache *cache;
+	int i;
+
+	if (!CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE || tt_cache_disabled)
+		return NULL;
+	if (met->cache)
+		return met->cache;
+
+	cache = malloc(sizeof(*cache));
+	if (!cache)
+		return NULL;
+	for (i = 0; i < TT_CACHED_CHARS; i++)
+		cache->chars[i].glyph = -1;
+	for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE; i++) {
+		cache->glyphs[i].glyph = -1;
+		cache->glyphs[i].data = NULL;
+	}
+	met->cache = cache;
+
+	return cache;
+}
+
+/**
+ * tt_free_cache() - Free the glyph cache for a font / size
+ *
+ * @met:	Metrics to update
+ */
+static void tt_free_cache(struct console_tt_metrics *met)
+{
+	struct console_tt_cache *cache = met->cache;
+	int i;
+
+	if (!cache)
+		return;
+	for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE; i++)
+		free(cache->glyphs[i].data);
+	free(cache);
+	met->cache = NULL;
+}
+
+/**
+ * tt_get_char() - Look up the glyph for a character
+ *
+ * This avoids searching the font's character map each time for common
+ * characters
+ *
+ * @met:	Metrics to use
+ * @cp:		Unicode code point to look up
+ * @advancep:	Returns the advance width of the character, in font units
+ * Return: glyph index of the character (0 if the font does not have it)
+ */
+static int tt_get_char(struct console_tt_metrics *met, int cp, int *advancep)
+{
+	struct console_tt_cache *cache = tt_get_cache(met);
+	struct console_tt_char *chr;
+
+	if (!cache || cp < 0 || cp >= TT_CACHED_CHARS) {
+		int glyph = stbtt_FindGlyphIndex(&met->font, cp);
+
+		stbtt_GetGlyphHMetrics(&met->font, glyph, advancep, NULL);
+
+		return glyph;
+	}
+
+	chr = &cache->chars[cp];
+	if (chr->glyph == -1) {
+		chr->glyph = stbtt_FindGlyphIndex(&met->font, cp);
+		stbtt_GetGlyphHMetrics(&met->font, chr->glyph, &chr->advance,
+				       NULL);
+	}
+	if (advancep)
+		*advancep = chr->advance;
+
+	return chr->glyph;
+}
+
+/**
+ * tt_get_glyph() - Get the rendered bitmap for a glyph
+ *
+ * This returns the glyph from the cache if possible, otherwise it is rendered
+ * and added to the cache. If the glyph cache is not available, the glyph is
+ * rendered into @tmp and the caller must free @tmp->data when done.
+ *
+ * @met:	Metrics to use
+ * @glyph:	Glyph index to render
+ * @shift:	Horizontal sub-pixel shift at which to render the glyph
+ * @tmp:	Place to render the glyph if the cache is not available
+ * Return: rendered glyph
+ */
+static struct console_tt_glyph *tt_get_glyph(struct console_tt_metrics *met,
+					     int glyph, float shift,
+					     struct console_tt_glyph *tmp)
+{
+	struct console_tt_cache *cache = tt_get_cache(met);
+	struct console_tt_glyph *gl = tmp;
+	int width, height, xoff, yoff;
+
+	if (cache) {
+		uint slot = (uint)glyph * 31 + (uint)(shift * 64);
+
+		gl = &cache->glyphs[slot % TT_GLYPH_SLOTS];
+		if (gl->glyph == glyph && gl->shift == shift)
+			return gl;
+		free(gl->data);
+	}
+
+	gl->data = stbtt_GetGlyphBitmapSubpixel(&met->font, met->scale,
+						met->scale, shift, 0, glyph,
+						&width, &height, &xoff, &yoff);
+	gl->shift = shift;
+	gl->width = width;
+	gl->height = height;
+	gl->xoff = xoff;
+	gl->yoff = yoff;
+
+	/* Don't keep a glyph which could not be rendered for lack of memory */
+	gl->glyph = !gl->data && width && height ? -1 : glyph;
+
+	return gl;
+}
+
+static inline u16 tt_rgb16(uint val)
+{
+	return val >> 3 | (val >> 2) << 5 | (val >> 3) << 11;
+}
+
+static inline u32 tt_rgb32(uint val, bool x2r10g10b10)
+{
+	if (x2r10g10b10)
+		return val << 2 | val << 12 | val << 22;
+
+	return val | val << 8 | val << 16;
+}
+
+/**
+ * tt_blit() - Draw a glyph into the frame buffer
+ *
+ * This converts the 8bpp image into the colour depth of the display. We only
+ * expect white-on-black or the reverse so the code only handles this simple
+ * case: the glyph is ORed into a black background or ANDed into a white one.
+ *
+ * @vid_priv:	Video device to draw on
+ * @line:	Frame-buffer address of the top-left corner of the glyph,
+ *		excluding its X offset
+ * @gl:		Glyph to draw
+ * Return: 0 if OK, -ENOSYS if the colour depth is not supported
+ */
+static int tt_blit(struct video_priv *vid_priv, void *line,
+		   const struct console_tt_glyph *gl)
+{
+	u8 inv = vid_priv->colour_bg ? 0xff : 0;
+	bool set = vid_priv->colour_fg;
+	const u8 *bits = gl->data;
+	int row, i;
+
+	switch (vid_priv->bpix) {
+	case VIDEO_BPP8:
+		if (!IS_ENABLED(CONFIG_VIDEO_BPP8))
+			break;
+		for (row = 0; row < gl->height; row++) {
+			u8 *dst = (u8 *)line + gl->xoff;
+
+			for (i = 0; i < gl->width; i++) {
+				u8 val = *bits++ ^ inv;
+
+				if (set)
+					dst[i] |= val;
+				else
+					dst[i] &= val;
+			}
+			line += vid_priv->line_length;
+		}
+		break;
+	case VIDEO_BPP16:
+		if (!IS_ENABLED(CONFIG_VIDEO_BPP16))
+			break;
+		for (row = 0; row < gl->height; row++) {
+			u16 *dst = (u16 *)line + gl->xoff;
+
+			if (set) {
+				for (i = 0; i < gl->width; i++)
+					dst[i] |= tt_rgb16(*bits++ ^ inv);
+			} else {
+				for (i = 0; i < gl->width; i++)
+					dst[i] &= tt_rgb16(*bits++ ^ inv);
+			}
+			line += vid_priv->line_length;
+		}
+		break;
+	case VIDEO_BPP32: {
+		bool x2r10 = vid_priv->format == VIDEO_X2R10G10B10;
+
+		if (!IS_ENABLED(CONFIG_VIDEO_BPP32))
+			break;
+		for (row = 0; row < gl->height; row++) {
+			u32 *dst = (u32 *)line + gl->xoff;
+
+			if (set) {
+				for (i = 0; i < gl->width; i++)
+					dst[i] |= tt_rgb32(*bits++ ^ inv, x2r10);
+			} else {
+				for (i = 0; i < gl->width; i++)
+					dst[i] &= tt_rgb32(*bits++ ^ inv, x2r10);
+			}
+			line += vid_priv->line_length;
+		}
+		break;
+	}
+	default:
+		return -ENOSYS;
+	}
+
+	return 0;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    int cp)
 {
@@ -270,18 +565,16 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	struct console_tt_metrics *met = priv->cur_met;
 	stbtt_fontinfo *font = &met->font;
-	int width, height, xoff, yoff;
+	struct console_tt_glyph *gl, tmp;
 	double xpos, x_shift;
-	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
-	int advance;
-	void *start, *end, *line;
-	int row, ret;
+	int advance, glyph;
+	void *start;
+	int ret;
 
 	/* First get some basic metrics about this character */
-	stbtt_GetCodepointHMetrics(font, cp, &advance, &lsb);
+	glyph = tt_get_char(met, cp, &advance);
 
 	/*
 	 * First out our current X position in fractional pixels. If we wrote
@@ -289,8 +582,10 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * this character */
 	xpos = frac(VID_TO_PIXEL((double)x));
 	if (vc_priv->last_ch) {
-		xpos += met->scale * stbtt_GetCodepointKernAdvance(font,
-							vc_priv->last_ch, cp);
+		int last = tt_get_char(met, vc_priv->last_ch, NULL);
+
+		xpos += met->scale * stbtt_GetGlyphKernAdvance(font, last,
+							       glyph);
 	}
 
 	/*
@@ -317,111 +612,27 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * Figure out how much past the start of a pixel we are, and pass this
 	 * information into the render, which will return a 8-bit-per-pixel
 	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * be NULL;
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, met->scale, met->scale,
-						x_shift, 0, cp, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+	gl = tt_get_glyph(met, glyph, x_shift, &tmp);
+	if (!gl->data)
 		return width_frac;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
 	start = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = met->baseline + yoff;
+	linenum = met->baseline + gl->yoff;
 	if (linenum > 0)
 		start += linenum * vid_priv->line_length;
-	line = start;
-
-	/*
-	 * Write a row at a time, converting the 8bpp image into the colour
-	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
-	 */
-	for (row = 0; row < height; row++) {
-		switch (vid_priv->bpix) {
-		case VIDEO_BPP8:
-			if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-				u8 *dst = line + xoff;
-				int i;
-
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
-			int i;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val >> 3 |
-						(val >> 2) << 5 |
-						(val >> 3) << 11;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		}
-		case VIDEO_BPP32: {
-			u32 *dst = (u32 *)line + xoff;
-			int i;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					if (vid_priv->format == VIDEO_X2R10G10B10)
-						out = val << 2 | val << 12 | val << 22;
-					else
-						out = val | val << 8 | val << 16;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		}
-		default:
-			free(data);
-			return -ENOSYS;
-		}
 
-		line += vid_priv->line_length;
-	}
-	ret = vidconsole_sync_copy(dev, start, line);
+	ret = tt_blit(vid_priv, start, gl);
+	if (!ret)
+		ret = vidconsole_sync_copy(dev, start, start + gl->height *
+					   vid_priv->line_length);
+	if (gl == &tmp)
+		free(tmp.data);
 	if (ret)
 		return ret;
-	free(data);
 
 	return width_frac;
 }
@@ -726,7 +937,7 @@ static int truetype_measure(struct udevice *dev, const char *name, uint size,
 {
 	struct console_tt_metrics *met;
 	stbtt_fontinfo *font;
-	int lsb, advance;
+	int advance;
 	const char *s;
 	int width;
 	int last;
@@ -742,18 +953,16 @@ static int truetype_measure(struct udevice *dev, const char *name, uint size,
 
 	font = &met->font;
 	width = 0;
-	for (last = 0, s = text; *s; s++) {
-		int ch = *s;
+	for (last = -1, s = text; *s; s++) {
+		/* First get some basic metrics about this character */
+		int glyph = tt_get_char(met, *s, &advance);
 
 		/* Used kerning to fine-tune the position of this character */
-		if (last)
-			width += stbtt_GetCodepointKernAdvance(font, last, ch);
-
-		/* First get some basic metrics about this character */
-		stbtt_GetCodepointHMetrics(font, ch, &advance, &lsb);
+		if (last != -1)
+			width += stbtt_GetGlyphKernAdvance(font, last, glyph);
 
 		width += advance;
-		last = ch;
+		last = glyph;
 	}
 
 	bbox->valid = true;
@@ -990,6 +1199,17 @@ static int console_truetype_probe(struct udevice *dev)
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i;
+
+	for (i = 0; i < priv->num_metrics; i++)
+		tt_free_cache(&priv->metrics[i]);
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -1011,5 +1231,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto	= sizeof(struct console_tt_priv),
 };
@@ -229,6 +229,16 @@ static int seps525_sync(struct udevice *vid)
 	int i, ret;
 	u8 data1, data2;
 	u8 *start = uc_priv->fb;
+	int ystart = 0, yend = uc_priv->ysize;
+
+	/* Only send the lines which have changed */
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		ystart = uc_priv->damage.y0;
+		yend = uc_priv->damage.y1;
+		if (ystart >= yend)
+			return 0;
+		start += ystart * uc_priv->line_length;
+	}
 
 	ret = dm_spi_claim_bus(dev);
 	if (ret) {
@@ -238,12 +248,12 @@ static int seps525_sync(struct udevice *vid)
 
 	/* start position X,Y */
 	seps525_spi_write(dev, SEPS525_MEMORY_ACCESS_POINTER_X, 0);
-	seps525_spi_write(dev, SEPS525_MEMORY_ACCESS_POINTER_Y, 0);
+	seps525_spi_write(dev, SEPS525_MEMORY_ACCESS_POINTER_Y, ystart);
 
 	/* Enable access for data */
 	(void)seps525_spi_write_cmd(dev, SEPS525_DDRAM_DATA_ACCESS_PORT);
 
-	for (i = 0; i < (uc_priv->xsize * uc_priv->ysize); i++) {
+	for (i = 0; i < uc_priv->xsize * (yend - ystart); i++) {
 		data2 = *start++;
 		data1 = *start++;
 		(void)seps525_spi_write_data(dev, data1);
@@ -346,12 +346,93 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = video_index_to_colour(priv, back);
 }
 
+static bool video_is_damaged(struct video_priv *priv)
+{
+	return priv->damage.x0 < priv->damage.x1 &&
+		priv->damage.y0 < priv->damage.y1;
+}
+
+#ifdef CONFIG_VIDEO_DAMAGE
+/**
+ * damage_add() - Add a region to the damaged region of a device
+ *
+ * @priv:	Device information
+ * @x0:		X start position in pixels from the left
+ * @y0:		Y start position in pixels from the top
+ * @x1:		X end position in pixels from the left (exclusive)
+ * @y1:		Y end position in pixels from the top (exclusive)
+ */
+static void damage_add(struct video_priv *priv, int x0, int y0, int x1, int y1)
+{
+	struct vid_bbox *damage = &priv->damage;
+
+	x0 = max(x0, 0);
+	y0 = max(y0, 0);
+	x1 = min(x1, (int)priv->xsize);
+	y1 = min(y1, (int)priv->ysize);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	if (!video_is_damaged(priv)) {
+		damage->x0 = x0;
+		damage->y0 = y0;
+		damage->x1 = x1;
+		damage->y1 = y1;
+	} else {
+		damage->x0 = min(damage->x0, x0);
+		damage->y0 = min(damage->y0, y0);
+		damage->x1 = max(damage->x1, x1);
+		damage->y1 = max(damage->y1, y1);
+	}
+}
+
+/**
+ * damage_add_bytes() - Mark a range of bytes in the frame buffer as damaged
+ *
+ * If the range lies within a single line, only the pixels it covers are marked.
+ * Otherwise all the lines it touches are marked.
+ *
+ * @priv:	Device information
+ * @offset:	Byte offset of the start of the range within the frame buffer
+ * @size:	Number of bytes in the range
+ */
+static void damage_add_bytes(struct video_priv *priv, long offset, long size)
+{
+	int y0, y1, x0, x1;
+
+	if (size <= 0 || !priv->line_length)
+		return;
+	y0 = offset / priv->line_length;
+	y1 = (offset + size + priv->line_length - 1) / priv->line_length;
+	x0 = 0;
+	x1 = priv->xsize;
+	if (y1 - y0 == 1 && priv->bpix >= VIDEO_BPP8) {
+		int bytes = VNBYTES(priv->bpix);
+		long start = offset - (long)y0 * priv->line_length;
+
+		x0 = start / bytes;
+		x1 = (start + size + bytes - 1) / bytes;
+	}
+	damage_add(priv, x0, y0, x1, y1);
+}
+
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	damage_add(dev_get_uclass_priv(vid), x, y, x + width, y + height);
+}
+#endif
+
 /* Flush video activity to the caches */
 int video_sync(struct udevice *vid, bool force)
 {
+	struct video_priv *priv = dev_get_uclass_priv(vid);
 	struct video_ops *ops = video_get_ops(vid);
 	int ret;
 
+	/* If nothing has been drawn, there is nothing to sync */
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE) && !force && !video_is_damaged(priv))
+		return 0;
+
 	if (ops && ops->video_sync) {
 		ret = ops->video_sync(vid);
 		if (ret)
@@ -364,22 +445,32 @@ int video_sync(struct udevice *vid, bool force)
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
-
 	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
+		ulong start = (ulong)priv->fb;
+		ulong end = start + priv->fb_size;
+
+		/* Only flush the lines which have changed */
+		if (IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+			end = start + priv->damage.y1 * priv->line_length;
+			start += priv->damage.y0 * priv->line_length;
+		}
+		if (end > start) {
+			flush_dcache_range(ALIGN_DOWN(start,
+						      CONFIG_SYS_CACHELINE_SIZE),
+					   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
+		}
 	}
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
-	if (force || get_timer(last_sync) > 100) {
-		sandbox_sdl_sync(priv->fb);
-		last_sync = get_timer(0);
-	}
+	/* Keep the damage until the display is actually updated */
+	if (!force && get_timer(last_sync) <= 100)
+		return 0;
+	sandbox_sdl_sync(priv->fb);
+	last_sync = get_timer(0);
 #endif
+	memset(&priv->damage, '\0', sizeof(priv->damage));
+
 	return 0;
 }
 
@@ -431,12 +522,12 @@ int video_get_ysize(struct udevice *dev)
 	return priv->ysize;
 }
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 int video_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
-	if (priv->copy_fb) {
+	if (priv->copy_fb || IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
 		long offset, size;
 
 		/* Find the offset of the first byte to copy */
@@ -477,7 +568,11 @@ int video_sync_copy(struct udevice *dev, void *from, void *to)
 			offset = 0;
 		}
 
-		memcpy(priv->copy_fb + offset, priv->fb + offset, size);
+#ifdef CONFIG_VIDEO_DAMAGE
+		damage_add_bytes(priv, offset, size);
+#endif
+		if (priv->copy_fb)
+			memcpy(priv->copy_fb + offset, priv->fb + offset, size);
 	}
 
 	return 0;
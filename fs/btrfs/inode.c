@@ -408,6 +408,30 @@ out:
 	return ret;
 }
 
+/*
+ * Read @len bytes of data at @logical into @dest, trying each copy in turn
+ *
+ * Return 0 if OK, -EIO if no copy could be read
+ */
+static int read_data_copies(struct btrfs_fs_info *fs_info, char *dest,
+			    u64 logical, u64 len)
+{
+	int num_copies;
+	u64 read;
+	int ret;
+	int i;
+
+	num_copies = btrfs_num_copies(fs_info, logical, len);
+	for (i = 1; i <= num_copies; i++) {
+		read = len;
+		ret = read_extent_data(fs_info, dest, logical, &read, i);
+		if (!ret && read == len)
+			return 0;
+	}
+
+	return -EIO;
+}
+
 /*
  * Read out regular extent.
  *
@@ -426,14 +450,12 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 	struct btrfs_key key;
 	u64 extent_num_bytes;
 	u64 disk_bytenr;
-	u64 read;
 	char *cbuf = NULL;
 	char *dbuf = NULL;
+	char *out;
 	u32 csize;
 	u32 dsize;
-	bool finished = false;
-	int num_copies;
-	int i;
+	bool direct;
 	int slot = path->slots[0];
 	int ret;
 
@@ -457,49 +479,40 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 		logical = btrfs_file_extent_disk_bytenr(leaf, fi) +
 			  btrfs_file_extent_offset(leaf, fi) +
 			  offset - key.offset;
-		read = len;
 
-		num_copies = btrfs_num_copies(fs_info, logical, len);
-		for (i = 1; i <= num_copies; i++) {
-			ret = read_extent_data(fs_info, dest, logical, &read, i);
-			if (ret < 0 || read != len)
-				continue;
-			finished = true;
-			break;
-		}
-		if (!finished)
-			return -EIO;
+		ret = read_data_copies(fs_info, dest, logical, len);
+		if (ret < 0)
+			return ret;
 		return len;
 	}
 
 	csize = btrfs_file_extent_disk_num_bytes(leaf, fi);
 	dsize = btrfs_file_extent_ram_bytes(leaf, fi);
 	disk_bytenr = btrfs_file_extent_disk_bytenr(leaf, fi);
-	num_copies = btrfs_num_copies(fs_info, disk_bytenr, csize);
+
+	/*
+	 * If the whole extent is wanted, decompress it straight into @dest
+	 * rather than into a bounce buffer
+	 */
+	direct = !btrfs_file_extent_offset(leaf, fi) && offset == key.offset &&
+		 len == dsize;
 
 	cbuf = malloc_cache_aligned(csize);
-	dbuf = malloc_cache_aligned(dsize);
-	if (!cbuf || !dbuf) {
+	if (!direct)
+		dbuf = malloc_cache_aligned(dsize);
+	if (!cbuf || (!direct && !dbuf)) {
 		ret = -ENOMEM;
 		goto out;
 	}
+	out = direct ? dest : dbuf;
+
 	/* For compressed extent, we must read the whole on-disk extent */
-	for (i = 1; i <= num_copies; i++) {
-		read = csize;
-		ret = read_extent_data(fs_info, cbuf, disk_bytenr,
-				       &read, i);
-		if (ret < 0 || read != csize)
-			continue;
-		finished = true;
-		break;
-	}
-	if (!finished) {
-		ret = -EIO;
+	ret = read_data_copies(fs_info, cbuf, disk_bytenr, csize);
+	if (ret < 0)
 		goto out;
-	}
 
 	ret = btrfs_decompress(btrfs_file_extent_compression(leaf, fi), cbuf,
-			       csize, dbuf, dsize);
+			       csize, out, dsize);
 	if (ret < 0) {
 		ret = -EIO;
 		goto out;
@@ -509,11 +522,11 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 	 * to be zeroed out.
 	 */
 	if (ret < dsize)
-		memset(dbuf + ret, 0, dsize - ret);
+		memset(out + ret, 0, dsize - ret);
 	/* Then copy the needed part */
-	memcpy(dest,
-	       dbuf + btrfs_file_extent_offset(leaf, fi) + offset - key.offset,
-	       len);
+	if (!direct)
+		memcpy(dest, dbuf + btrfs_file_extent_offset(leaf, fi) +
+		       offset - key.offset, len);
 	ret = len;
 out:
 	free(cbuf);
@@ -668,6 +681,9 @@ int btrfs_file_read(struct btrfs_root *root, u64 ino, u64 file_offset, u64 len,
 	u64 aligned_end = round_down(file_offset + len, fs_info->sectorsize);
 	u64 next_offset;
 	u64 cur = aligned_start;
+	u64 pending_start = 0;
+	u64 pending_logical = 0;
+	u64 pending_len = 0;
 	int ret = 0;
 
 	btrfs_init_path(&path);
@@ -701,9 +717,15 @@ int btrfs_file_read(struct btrfs_root *root, u64 ino, u64 file_offset, u64 len,
 		}
 	}
 
-	/* Read the aligned part */
+	/*
+	 * Read the aligned part. Uncompressed extents which follow each other
+	 * on disk, as is usual for a file written in one go, are merged into
+	 * a single read.
+	 */
 	while (cur < aligned_end) {
-		u64 extent_num_bytes;
+		u64 extent_end;
+		u64 logical;
+		u64 read_len;
 		u8 type;
 
 		btrfs_release_path(&path);
@@ -714,7 +736,7 @@ int btrfs_file_read(struct btrfs_root *root, u64 ino, u64 file_offset, u64 len,
 			/* No next, direct exit */
 			if (!next_offset) {
 				ret = 0;
-				goto out;
+				break;
 			}
 			/*
 			 * Find a extent gap, mostly caused by NO_HOLE feature.
@@ -742,14 +764,51 @@ int btrfs_file_read(struct btrfs_root *root, u64 ino, u64 file_offset, u64 len,
 		}
 
 		/* Read the remaining part of the extent */
-		extent_num_bytes = btrfs_file_extent_num_bytes(path.nodes[0],
-							       fi);
-		ret = btrfs_read_extent_reg(&path, fi, cur,
-				min(extent_num_bytes, aligned_end - cur),
-				dest + cur - file_offset);
+		extent_end = key.offset + btrfs_file_extent_num_bytes(
+				path.nodes[0], fi);
+		read_len = min(extent_end, aligned_end) - cur;
+		if (btrfs_file_extent_compression(path.nodes[0], fi) ==
+		    BTRFS_COMPRESS_NONE) {
+			logical = btrfs_file_extent_disk_bytenr(path.nodes[0],
+								fi) +
+				  btrfs_file_extent_offset(path.nodes[0], fi) +
+				  cur - key.offset;
+			if (pending_len && cur == pending_start + pending_len &&
+			    logical == pending_logical + pending_len) {
+				pending_len += read_len;
+				cur += read_len;
+				continue;
+			}
+		}
+
+		if (pending_len) {
+			ret = read_data_copies(fs_info,
+					       dest + pending_start - file_offset,
+					       pending_logical, pending_len);
+			if (ret < 0)
+				goto out;
+			pending_len = 0;
+		}
+
+		if (btrfs_file_extent_compression(path.nodes[0], fi) ==
+		    BTRFS_COMPRESS_NONE) {
+			pending_start = cur;
+			pending_logical = logical;
+			pending_len = read_len;
+		} else {
+			ret = btrfs_read_extent_reg(&path, fi, cur, read_len,
+						    dest + cur - file_offset);
+			if (ret < 0)
+				goto out;
+		}
+		cur += read_len;
+	}
+
+	if (pending_len) {
+		ret = read_data_copies(fs_info, dest + pending_start - file_offset,
+				       pending_logical, pending_len);
 		if (ret < 0)
 			goto out;
-		cur += min(extent_num_bytes, aligned_end - cur);
 	}
 
 	/* Read the tailing unaligned part*/
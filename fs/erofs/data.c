@@ -216,11 +216,63 @@ static int erofs_read_raw_data(struct erofs_inode *inode, char *buffer,
 	return 0;
 }
 
+/*
+ * Get the compressed data at @pa, reading it into @raw if it is not there
+ * already. Up to @ahead bytes before @pa are read as well, since extents are
+ * read from the end of the file backwards.
+ */
+static char *z_erofs_read_raw(struct z_erofs_rawbuf *raw,
+			      unsigned int deviceid, erofs_off_t pa,
+			      unsigned int plen, erofs_off_t ahead)
+{
+	erofs_off_t start;
+	unsigned int len;
+	int ret;
+
+	if (raw->len && deviceid == raw->deviceid && pa >= raw->pa &&
+	    pa + plen <= raw->pa + raw->len)
+		return raw->buf + (pa - raw->pa);
+
+	ahead = min3(ahead, pa, (erofs_off_t)Z_EROFS_RAW_WINDOW);
+	start = round_down(pa - ahead, erofs_blksiz());
+	len = pa + plen - start;
+	if (len > raw->size) {
+		free(raw->buf);
+		raw->len = 0;
+		raw->buf = malloc(len);
+		if (!raw->buf) {
+			/* fall back to reading just what is needed */
+			start = pa;
+			len = plen;
+			raw->buf = malloc(len);
+			if (!raw->buf) {
+				raw->size = 0;
+				return ERR_PTR(-ENOMEM);
+			}
+		}
+		raw->size = len;
+	}
+
+	ret = erofs_dev_read(deviceid, raw->buf, start, len);
+	if (ret < 0) {
+		raw->len = 0;
+		return ERR_PTR(ret);
+	}
+	raw->deviceid = deviceid;
+	raw->pa = start;
+	raw->len = len;
+
+	return raw->buf + (pa - start);
+}
+
 int z_erofs_read_one_data(struct erofs_inode *inode,
-			  struct erofs_map_blocks *map, char *raw, char *buffer,
-			  erofs_off_t skip, erofs_off_t length, bool trimmed)
+			  struct erofs_map_blocks *map,
+			  struct z_erofs_rawbuf *raw, erofs_off_t ahead,
+			  char *buffer, erofs_off_t skip, erofs_off_t length,
+			  bool trimmed)
 {
 	struct erofs_map_dev mdev;
+	char *in;
 	int ret = 0;
 
 	if (map->m_flags & EROFS_MAP_FRAGMENT) {
@@ -248,12 +300,13 @@ int z_erofs_read_one_data(struct erofs_inode *inode,
 		return ret;
 	}
 
-	ret = erofs_dev_read(mdev.m_deviceid, raw, mdev.m_pa, map->m_plen);
-	if (ret < 0)
-		return ret;
+	in = z_erofs_read_raw(raw, mdev.m_deviceid, mdev.m_pa, map->m_plen,
+			      ahead);
+	if (IS_ERR(in))
+		return PTR_ERR(in);
 
 	ret = z_erofs_decompress(&(struct z_erofs_decompress_req) {
-			.in = raw,
+			.in = in,
 			.out = buffer,
 			.decodedskip = skip,
 			.interlaced_offset =
@@ -278,9 +331,8 @@ static int z_erofs_read_data(struct erofs_inode *inode, char *buffer,
 	struct erofs_map_blocks map = {
 		.index = UINT_MAX,
 	};
+	struct z_erofs_rawbuf raw = {};
 	bool trimmed;
-	unsigned int bufsize = 0;
-	char *raw = NULL;
 	int ret = 0;
 
 	end = offset + size;
@@ -318,23 +370,17 @@ static int z_erofs_read_data(struct erofs_inode *inode, char *buffer,
 			continue;
 		}
 
-		if (map.m_plen > bufsize) {
-			bufsize = map.m_plen;
-			raw = realloc(raw, bufsize);
-			if (!raw) {
-				ret = -ENOMEM;
-				break;
-			}
-		}
-
-		ret = z_erofs_read_one_data(inode, &map, raw,
+		/*
+		 * The extents before this one are read next; their compressed
+		 * data is no larger than what is left to decompress
+		 */
+		ret = z_erofs_read_one_data(inode, &map, &raw, end - offset,
 					    buffer + end - offset, skip, length,
 					    trimmed);
 		if (ret < 0)
 			break;
 	}
-	if (raw)
-		free(raw);
+	free(raw.buf);
 	return ret < 0 ? ret : 0;
 }
 
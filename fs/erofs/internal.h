@@ -320,6 +320,22 @@ struct erofs_map_dev {
 	unsigned int m_deviceid;
 };
 
+/*
+ * Compressed data read from the device for a file. Pclusters are normally
+ * stored one after another, so several of them are read at once and later
+ * extents are taken from here if they fall within the window.
+ */
+struct z_erofs_rawbuf {
+	char *buf;
+	unsigned int size;	/* size of the allocation at buf */
+	unsigned int deviceid;
+	erofs_off_t pa;		/* device address of buf */
+	unsigned int len;	/* number of valid bytes at buf */
+};
+
+/* Largest amount of compressed data read in one go */
+#define Z_EROFS_RAW_WINDOW	(128 * 1024)
+
 /* fs.c */
 int erofs_blk_read(void *buf, erofs_blk_t start, u32 nblocks);
 int erofs_dev_read(int device_id, void *buf, u64 offset, size_t len);
@@ -342,8 +358,10 @@ int erofs_map_dev(struct erofs_map_dev *map);
 int erofs_read_one_data(struct erofs_map_blocks *map, char *buffer, u64 offset,
 			size_t len);
 int z_erofs_read_one_data(struct erofs_inode *inode,
-			  struct erofs_map_blocks *map, char *raw, char *buffer,
-			  erofs_off_t skip, erofs_off_t length, bool trimmed);
+			  struct erofs_map_blocks *map,
+			  struct z_erofs_rawbuf *raw, erofs_off_t ahead,
+			  char *buffer, erofs_off_t skip, erofs_off_t length,
+			  bool trimmed);
 
 static inline int erofs_get_occupied_size(const struct erofs_inode *inode,
 					  erofs_off_t *size)
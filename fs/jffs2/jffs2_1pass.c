@@ -169,16 +169,81 @@ static struct part_info *current_part;
 #endif
 #define NAND_CACHE_SIZE (NAND_CACHE_PAGES*NAND_PAGE_SIZE)
 
-static u8* nand_cache = NULL;
-static u32 nand_cache_off = (u32)-1;
+/*
+ * Directory entries and the nodes of a file are spread all over the
+ * partition, so keep several windows of flash data and reuse the least
+ * recently used one on a miss. A window never crosses an eraseblock
+ * boundary, so reading the summary at the end of an eraseblock does not
+ * also read the start of the next one.
+ */
+struct nand_cache_ent {
+	u8 *buf;	/* cached data, NAND_CACHE_SIZE bytes */
+	u32 off;	/* flash offset of buf[0] */
+	u32 len;	/* number of valid bytes in buf, 0 if unused */
+	u32 used;	/* value of nand_cache_tick when last used */
+};
+
+static struct nand_cache_ent nand_cache[CONFIG_JFFS2_NAND_CACHE_ENTRIES];
+static u32 nand_cache_tick;
+
+static struct nand_cache_ent *nand_cache_get(struct mtd_info *mtd, u32 off)
+{
+	struct nand_cache_ent *ent, *victim = &nand_cache[0];
+	u32 align, end;
+	size_t retlen;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(nand_cache); i++) {
+		ent = &nand_cache[i];
+		if (ent->len && off >= ent->off && off < ent->off + ent->len) {
+			ent->used = ++nand_cache_tick;
+			return ent;
+		}
+		if (ent->used < victim->used)
+			victim = ent;
+	}
+
+	ent = victim;
+	if (!ent->buf) {
+		/* This memory never gets freed but 'cause
+		   it's a bootloader, nobody cares */
+		ent->buf = malloc(NAND_CACHE_SIZE);
+		if (!ent->buf) {
+			printf("read_nand_cached: can't alloc cache size %d bytes\n",
+			       NAND_CACHE_SIZE);
+			return NULL;
+		}
+	}
+
+	/* read whole pages where the cache is big enough for that */
+	align = NAND_PAGE_SIZE;
+	if (mtd->writesize > align && mtd->writesize <= NAND_CACHE_SIZE)
+		align = mtd->writesize;
+	ent->off = off & ~(align - 1);
+	end = min_t(u64, ent->off + NAND_CACHE_SIZE, mtd->size);
+	end = min(end, (ent->off / mtd->erasesize + 1) * mtd->erasesize);
+
+	ent->len = 0;
+	retlen = end - ent->off;
+	if (nand_read(mtd, ent->off, &retlen, ent->buf) < 0 ||
+	    retlen != end - ent->off) {
+		printf("read_nand_cached: error reading nand off %#x size %d bytes\n",
+		       ent->off, end - ent->off);
+		return NULL;
+	}
+	ent->len = end - ent->off;
+	ent->used = ++nand_cache_tick;
+
+	return ent;
+}
 
 static int read_nand_cached(u32 off, u32 size, u_char *buf)
 {
 	struct mtdids *id = current_part->dev->id;
+	struct nand_cache_ent *ent;
 	struct mtd_info *mtd;
 	u32 bytes_read = 0;
-	size_t retlen;
-	size_t toread;
+	u32 pos;
 	int cpy_bytes;
 
 	mtd = get_nand_dev_by_index(id->num);
@@ -186,43 +251,14 @@ static int read_nand_cached(u32 off, u32 size, u_char *buf)
 		return -1;
 
 	while (bytes_read < size) {
-		retlen = NAND_CACHE_SIZE;
-		if( nand_cache_off + retlen > mtd->size )
-			retlen = mtd->size - nand_cache_off;
-
-		if ((off + bytes_read < nand_cache_off) ||
-		    (off + bytes_read >= nand_cache_off + retlen)) {
-			nand_cache_off = (off + bytes_read) & NAND_PAGE_MASK;
-			if (!nand_cache) {
-				/* This memory never gets freed but 'cause
-				   it's a bootloader, nobody cares */
-				nand_cache = malloc(NAND_CACHE_SIZE);
-				if (!nand_cache) {
-					printf("read_nand_cached: can't alloc cache size %d bytes\n",
-					       NAND_CACHE_SIZE);
-					return -1;
-				}
-			}
-
-			toread = NAND_CACHE_SIZE;
-			if( nand_cache_off + toread > mtd->size )
-				toread = mtd->size - nand_cache_off;
-
-			retlen = toread;
-			if (nand_read(mtd, nand_cache_off,
-				      &retlen, nand_cache) < 0 ||
-					retlen != toread) {
-				printf("read_nand_cached: error reading nand off %#x size %d bytes\n",
-						nand_cache_off, toread);
-				return -1;
-			}
-		}
-		cpy_bytes = nand_cache_off + retlen - (off + bytes_read);
+		pos = off + bytes_read;
+		ent = nand_cache_get(mtd, pos);
+		if (!ent)
+			return -1;
+		cpy_bytes = ent->off + ent->len - pos;
 		if (cpy_bytes > size - bytes_read)
 			cpy_bytes = size - bytes_read;
-		memcpy(buf + bytes_read,
-		       nand_cache + off + bytes_read - nand_cache_off,
-		       cpy_bytes);
+		memcpy(buf + bytes_read, ent->buf + pos - ent->off, cpy_bytes);
 		bytes_read += cpy_bytes;
 	}
 	return bytes_read;
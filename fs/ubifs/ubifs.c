@@ -665,23 +665,17 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+/*
+ * Uncompress the data node @dn for @block of @inode into @addr, zeroing the
+ * rest of the block if the node holds less than a whole block
+ */
+static int unpack_data_node(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int block,
+			    struct ubifs_data_node *dn)
 {
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -712,6 +706,72 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return unpack_data_node(c, inode, addr, block, dn);
+}
+
+/*
+ * Read up to @count blocks starting at @block with a single flash read, using
+ * the bulk-read support in the TNC. This works when the data nodes sit next to
+ * each other in one LEB, which is normally the case for a file which was
+ * written in one go. Blocks between the nodes found are holes.
+ *
+ * Returns the number of blocks read, 0 if no data node was found so the caller
+ * should read block by block, or a negative error code
+ */
+static int read_blocks_bulk(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int block, unsigned int count,
+			    struct bu_info *bu)
+{
+	unsigned int b, next = block;
+	void *buf;
+	int err, i;
+
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err)
+		return err;
+	if (!bu->cnt)
+		return 0;
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		return err;
+
+	buf = bu->buf;
+	for (i = 0; i < bu->cnt; i++) {
+		b = key_block(c, &bu->zbranch[i].key);
+		if (b >= block + count)
+			break;
+		memset(addr + (next - block) * UBIFS_BLOCK_SIZE, 0,
+		       (b - next) * UBIFS_BLOCK_SIZE);
+		err = unpack_data_node(c, inode,
+				       addr + (b - block) * UBIFS_BLOCK_SIZE,
+				       b, buf);
+		if (err)
+			return err;
+		buf += ALIGN(bu->zbranch[i].len, 8);
+		next = b + 1;
+	}
+
+	return next - block;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -829,11 +889,12 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	       loff_t size, loff_t *actread)
 {
 	struct ubifs_info *c = ubifs_sb->s_fs_info;
+	struct bu_info *bu = NULL;
 	unsigned long inum;
 	struct inode *inode;
 	struct page page;
 	int err = 0;
-	int i;
+	int i, ret;
 	int count;
 	int last_block_size = 0;
 
@@ -880,6 +941,22 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 
 	count = (size + UBIFS_BLOCK_SIZE - 1) >> UBIFS_BLOCK_SHIFT;
 
+	/*
+	 * Read whole blocks in bulk where possible; the last one is left to
+	 * do_readpage() which takes care not to write beyond @size
+	 */
+	if (UBIFS_BLOCKS_PER_PAGE == 1 && count > 1) {
+		bu = malloc(sizeof(*bu));
+		if (bu) {
+			bu->buf_len = c->max_bu_buf_len;
+			bu->buf = malloc(bu->buf_len);
+			if (!bu->buf) {
+				free(bu);
+				bu = NULL;
+			}
+		}
+	}
+
 	page.addr = buf;
 	page.index = offset / PAGE_SIZE;
 	page.inode = inode;
@@ -887,8 +964,22 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 		/*
 		 * Make sure to not read beyond the requested size
 		 */
-		if (((i + 1) == count) && (size < inode->i_size))
+		if (((i + 1) == count) && (size < inode->i_size)) {
 			last_block_size = size - (i * PAGE_SIZE);
+		} else if (bu && i + 1 < count) {
+			ret = read_blocks_bulk(c, inode, page.addr, page.index,
+					       count - i - 1, bu);
+			if (ret < 0) {
+				err = ret;
+				break;
+			}
+			if (ret) {
+				i += ret - 1;
+				page.addr += ret * PAGE_SIZE;
+				page.index += ret;
+				continue;
+			}
+		}
 
 		err = do_readpage(c, inode, &page, last_block_size);
 		if (err)
@@ -905,6 +996,11 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 		*actread = size;
 	}
 
+	if (bu) {
+		free(bu->buf);
+		free(bu);
+	}
+
 put_inode:
 	ubifs_iput(inode);
 
@@ -18,6 +18,7 @@
 #include <asm/byteorder.h>
 #include "zfs_common.h"
 #include "div64.h"
+#include <u-boot/lz4.h>
 
 struct blk_desc *zfs_dev_desc;
 
@@ -141,6 +142,16 @@ typedef struct dnode_end {
 	zfs_endian_t endian;
 } dnode_end_t;
 
+/*
+ * Indirect block last read at one level of the block tree. Reading a file
+ * block by block goes through the same indirect blocks many times over.
+ */
+struct zfs_ind_cache {
+	blkptr_t bp;
+	zfs_endian_t endian;
+	void *buf;
+};
+
 struct zfs_data {
 	/* cache for a file block of the currently zfs_open()-ed file */
 	char *file_buf;
@@ -155,6 +166,9 @@ struct zfs_data {
 	uint64_t label_txg;
 	uint64_t pool_guid;
 
+	/* cache for indirect blocks, indexed by level - 1 */
+	struct zfs_ind_cache ind_cache[DN_MAX_LEVELS];
+
 	/* cache for a dnode block */
 	dnode_phys_t *dnode_buf;
 	dnode_phys_t *dnode_mdn;
@@ -187,6 +201,29 @@ zlib_decompress(void *s, void *d,
 	return ZFS_ERR_NONE;
 }
 
+#if IS_ENABLED(CONFIG_LZ4)
+/*
+ * The data starts with the length of the compressed stream as a 32-bit
+ * big-endian value, followed by an LZ4 block
+ */
+static int
+lz4_decompress(void *s, void *d, uint32_t slen, uint32_t dlen)
+{
+	uint32_t len;
+
+	if (slen < sizeof(len))
+		return ZFS_ERR_BAD_FS;
+	len = be32_to_cpu(*(uint32_t *)s);
+	if (len > slen - sizeof(len))
+		return ZFS_ERR_BAD_FS;
+	if (LZ4_decompress_safe((char *)s + sizeof(len), d, len, dlen) < 0)
+		return ZFS_ERR_BAD_FS;
+	return ZFS_ERR_NONE;
+}
+#else
+#define lz4_decompress	NULL
+#endif
+
 static decomp_entry_t decomp_table[ZIO_COMPRESS_FUNCTIONS] = {
 	{"inherit", NULL},		/* ZIO_COMPRESS_INHERIT */
 	{"on", lzjb_decompress},	/* ZIO_COMPRESS_ON */
@@ -202,6 +239,8 @@ static decomp_entry_t decomp_table[ZIO_COMPRESS_FUNCTIONS] = {
 	{"gzip-7", zlib_decompress},  /* ZIO_COMPRESS_GZIP7 */
 	{"gzip-8", zlib_decompress},  /* ZIO_COMPRESS_GZIP8 */
 	{"gzip-9", zlib_decompress},  /* ZIO_COMPRESS_GZIP9 */
+	{"zle", NULL},		/* ZIO_COMPRESS_ZLE */
+	{"lz4", lz4_decompress},	/* ZIO_COMPRESS_LZ4 */
 };
 
 
@@ -355,13 +394,13 @@ uberblock_verify(uberblock_t *uber, int offset, struct zfs_data *data)
 	}
 
 	if (zfs_to_cpu64(uber->ub_magic, LITTLE_ENDIAN) == UBERBLOCK_MAGIC
-		&& zfs_to_cpu64(uber->ub_version, LITTLE_ENDIAN) > 0
-		&& zfs_to_cpu64(uber->ub_version, LITTLE_ENDIAN) <= SPA_VERSION)
+		&& SPA_VERSION_IS_SUPPORTED(zfs_to_cpu64(uber->ub_version,
+												 LITTLE_ENDIAN)))
 		endian = LITTLE_ENDIAN;
 
 	if (zfs_to_cpu64(uber->ub_magic, BIG_ENDIAN) == UBERBLOCK_MAGIC
-		&& zfs_to_cpu64(uber->ub_version, BIG_ENDIAN) > 0
-		&& zfs_to_cpu64(uber->ub_version, BIG_ENDIAN) <= SPA_VERSION)
+		&& SPA_VERSION_IS_SUPPORTED(zfs_to_cpu64(uber->ub_version,
+												 BIG_ENDIAN)))
 		endian = BIG_ENDIAN;
 
 	if (endian == UNKNOWN_ENDIAN) {
@@ -435,6 +474,23 @@ get_psize(blkptr_t *bp, zfs_endian_t endian)
 			<< SPA_MINBLOCKSHIFT;
 }
 
+static inline int
+bp_is_embedded(blkptr_t *bp, zfs_endian_t endian)
+{
+	return (zfs_to_cpu64(bp->blk_prop, endian) >> 39) & 1;
+}
+
+/*
+ * With the hole_birth feature, a hole keeps the txg in which it was made, so
+ * an empty address is what marks it
+ */
+static inline int
+bp_is_hole(blkptr_t *bp, zfs_endian_t endian)
+{
+	return BP_IS_HOLE(bp) || (!bp_is_embedded(bp, endian) &&
+		!bp->blk_dva[0].dva_word[0] && !bp->blk_dva[0].dva_word[1]);
+}
+
 static uint64_t
 dva_get_offset(dva_t *dva, zfs_endian_t endian)
 {
@@ -551,6 +607,28 @@ zio_read_data(blkptr_t *bp, zfs_endian_t endian, void *buf,
 	return err;
 }
 
+/*
+ * Copy out the data held in an embedded block pointer (embedded_data
+ * feature). The data is stored in all of the words of the block pointer other
+ * than blk_prop and blk_birth.
+ */
+static void
+zio_read_embedded(blkptr_t *bp, zfs_endian_t endian, char *buf, size_t psize)
+{
+	uint64_t *wp = (uint64_t *)bp;
+	uint64_t w = 0;
+	size_t i;
+
+	for (i = 0; i < psize; i++) {
+		if (!(i % sizeof(w))) {
+			if (wp == &bp->blk_prop || wp == &bp->blk_birth)
+				wp++;
+			w = zfs_to_cpu64(*wp++, endian);
+		}
+		buf[i] = w >> ((i % sizeof(w)) * NBBY);
+	}
+}
+
 /*
  * Read in a block of data, verify its checksum, decompress if needed,
  * and put the uncompressed data in buf.
@@ -559,18 +637,25 @@ static int
 zio_read(blkptr_t *bp, zfs_endian_t endian, void **buf,
 		 size_t *size, struct zfs_data *data)
 {
+	uint64_t prop = zfs_to_cpu64(bp->blk_prop, endian);
 	size_t lsize, psize;
 	unsigned int comp;
 	char *compbuf = NULL;
+	int embedded;
 	int err;
 
 	*buf = NULL;
 
-	comp = (zfs_to_cpu64((bp)->blk_prop, endian)>>32) & 0xff;
-	lsize = (BP_IS_HOLE(bp) ? 0 :
-			 (((zfs_to_cpu64((bp)->blk_prop, endian) & 0xffff) + 1)
-			  << SPA_MINBLOCKSHIFT));
-	psize = get_psize(bp, endian);
+	embedded = bp_is_embedded(bp, endian);
+	comp = (prop >> 32) & 0x7f;
+	if (embedded) {
+		lsize = (prop & 0x1ffffff) + 1;
+		psize = ((prop >> 25) & 0x7f) + 1;
+	} else {
+		lsize = (bp_is_hole(bp, endian) ? 0 :
+				 (((prop & 0xffff) + 1) << SPA_MINBLOCKSHIFT));
+		psize = get_psize(bp, endian);
+	}
 
 	if (size)
 		*size = lsize;
@@ -591,9 +676,24 @@ zio_read(blkptr_t *bp, zfs_endian_t endian, void **buf,
 			return ZFS_ERR_OUT_OF_MEMORY;
 	} else {
 		compbuf = *buf = malloc(lsize);
+		if (!compbuf)
+			return ZFS_ERR_OUT_OF_MEMORY;
 	}
 
-	err = zio_read_data(bp, endian, compbuf, data);
+	if (embedded) {
+		/* only BP_EMBEDDED_TYPE_DATA is defined */
+		if (((prop >> 40) & 0xff) ||
+			psize > sizeof(*bp) - 2 * sizeof(uint64_t) ||
+			(comp == ZIO_COMPRESS_OFF && psize != lsize)) {
+			free(compbuf);
+			*buf = NULL;
+			return ZFS_ERR_BAD_FS;
+		}
+		zio_read_embedded(bp, endian, compbuf, psize);
+		err = ZFS_ERR_NONE;
+	} else {
+		err = zio_read_data(bp, endian, compbuf, data);
+	}
 	if (err) {
 		free(compbuf);
 		*buf = NULL;
@@ -619,6 +719,35 @@ zio_read(blkptr_t *bp, zfs_endian_t endian, void **buf,
 	return ZFS_ERR_NONE;
 }
 
+/*
+ * Read an indirect block at the given level, using the copy from the last call
+ * if it is the same block. The buffer belongs to the cache and must not be
+ * freed by the caller.
+ */
+static int
+dmu_read_indirect(blkptr_t *bp, zfs_endian_t endian, int level, void **buf,
+				  struct zfs_data *data)
+{
+	struct zfs_ind_cache *ic = &data->ind_cache[level - 1];
+	int err;
+
+	if (ic->buf && ic->endian == endian && !memcmp(&ic->bp, bp, sizeof(*bp))) {
+		*buf = ic->buf;
+		return ZFS_ERR_NONE;
+	}
+
+	free(ic->buf);
+	ic->buf = NULL;
+	err = zio_read(bp, endian, buf, 0, data);
+	if (err)
+		return err;
+	ic->bp = *bp;
+	ic->endian = endian;
+	ic->buf = *buf;
+
+	return ZFS_ERR_NONE;
+}
+
 /*
  * Get the block from a block id.
  * push the block onto the stack.
@@ -636,6 +765,9 @@ dmu_read(dnode_end_t *dn, uint64_t blkid, void **buf,
 	zfs_endian_t endian;
 	int err = ZFS_ERR_NONE;
 
+	if (dn->dn.dn_nlevels > DN_MAX_LEVELS)
+		return ZFS_ERR_BAD_FS;
+
 	bp = malloc(sizeof(blkptr_t));
 	if (!bp)
 		return ZFS_ERR_OUT_OF_MEMORY;
@@ -644,12 +776,8 @@ dmu_read(dnode_end_t *dn, uint64_t blkid, void **buf,
 	for (level = dn->dn.dn_nlevels - 1; level >= 0; level--) {
 		idx = (blkid >> (epbs * level)) & ((1 << epbs) - 1);
 		*bp = bp_array[idx];
-		if (bp_array != dn->dn.dn_blkptr) {
-			free(bp_array);
-			bp_array = 0;
-		}
 
-		if (BP_IS_HOLE(bp)) {
+		if (bp_is_hole(bp, endian)) {
 			size_t size = zfs_to_cpu16(dn->dn.dn_datablkszsec,
 											dn->endian)
 				<< SPA_MINBLOCKSHIFT;
@@ -667,14 +795,12 @@ dmu_read(dnode_end_t *dn, uint64_t blkid, void **buf,
 			endian = (zfs_to_cpu64(bp->blk_prop, endian) >> 63) & 1;
 			break;
 		}
-		err = zio_read(bp, endian, &tmpbuf, 0, data);
+		err = dmu_read_indirect(bp, endian, level, &tmpbuf, data);
 		endian = (zfs_to_cpu64(bp->blk_prop, endian) >> 63) & 1;
 		if (err)
 			break;
 		bp_array = tmpbuf;
 	}
-	if (bp_array != dn->dn.dn_blkptr)
-		free(bp_array);
 	if (endian_out)
 		*endian_out = endian;
 
@@ -1787,7 +1913,7 @@ check_pool_label(struct zfs_data *data)
 		return ZFS_ERR_BAD_FS;
 	}
 
-	if (version > SPA_VERSION) {
+	if (!SPA_VERSION_IS_SUPPORTED(version)) {
 		free(nvlist);
 		printf("SPA version too new %llu > %llu\n",
 			   (unsigned long long) version,
@@ -1839,6 +1965,70 @@ check_pool_label(struct zfs_data *data)
 	return ZFS_ERR_NONE;
 }
 
+/*
+ * Features which may be active in a pool that we read. Besides the ones that
+ * change how blocks are stored, this includes those that only change pool
+ * metadata we never look at. Several are active as soon as they are enabled,
+ * so they are found in any pool made by a recent release.
+ */
+static const char *const zfs_features_for_read[] = {
+	"org.illumos:lz4_compress",
+	"com.delphix:hole_birth",
+	"com.delphix:embedded_data",
+	"com.delphix:extensible_dataset",
+	"com.delphix:head_errlog",
+	"com.klarasystems:vdev_zaps_v2",
+	NULL
+};
+
+static int
+check_feature(const char *name, uint64_t val, struct zfs_data *data)
+{
+	int i;
+
+	/* skip unused entries and features which are enabled but not active */
+	if (!*name || !val)
+		return 0;
+
+	for (i = 0; zfs_features_for_read[i]; i++) {
+		if (!strcmp(name, zfs_features_for_read[i]))
+			return 0;
+	}
+	printf("zfs feature '%s' not supported\n", name);
+
+	return 1;
+}
+
+/*
+ * A pool with feature flags (version 5000) lists the active features that a
+ * reader must understand in the MOS. Refuse the pool if any are unknown.
+ */
+static int
+check_mos_features(struct zfs_data *data)
+{
+	dnode_end_t dn;
+	uint64_t objnum;
+	int err;
+
+	err = dnode_get(&data->mos, DMU_POOL_DIRECTORY_OBJECT,
+					DMU_OT_OBJECT_DIRECTORY, &dn, data);
+	if (err)
+		return err;
+
+	err = zap_lookup(&dn, DMU_POOL_FEATURES_FOR_READ, &objnum, data);
+	if (err)
+		return err;
+
+	err = dnode_get(&data->mos, objnum, 0, &dn, data);
+	if (err)
+		return err;
+
+	if (zap_iterate(&dn, check_feature, data))
+		return ZFS_ERR_NOT_IMPLEMENTED_YET;
+
+	return ZFS_ERR_NONE;
+}
+
 /*
  * vdev_label_start returns the physical disk offset (in bytes) of
  * label "l".
@@ -1853,6 +2043,10 @@ static uint64_t vdev_label_start(uint64_t psize, int l)
 void
 zfs_unmount(struct zfs_data *data)
 {
+	int i;
+
+	for (i = 0; i < DN_MAX_LEVELS; i++)
+		free(data->ind_cache[i].buf);
 	free(data->dnode_buf);
 	free(data->dnode_mdn);
 	free(data->file_buf);
@@ -2000,6 +2194,13 @@ zfs_mount(device_t dev)
 	free(osp);
 	free(ubbest);
 
+	if (zfs_to_cpu64(data->current_uberblock.ub_version, ub_endian) ==
+		SPA_VERSION_FEATURES && check_mos_features(data)) {
+		printf("zfs pool uses unsupported features\n");
+		zfs_unmount(data);
+		return 0;
+	}
+
 	return data;
 }
 
@@ -51,15 +51,40 @@ fletcher_2_endian(const void *buf, uint64_t size,
 	zcp->zc_word[3] = cpu_to_zfs64(b1, endian);
 }
 
+/*
+ * The running sums are kept for the even and odd words separately, so the
+ * two halves do not wait on each other, and then combined. With n words and
+ * per-lane sums over m = n / 2 words, word j = 2k + l is weighted by
+ * (2 * (m - k) - l) in b and by the corresponding binomials in c and d,
+ * which gives the correction terms below.
+ */
 void
 fletcher_4_endian(const void *buf, uint64_t size, zfs_endian_t endian,
 				  zio_cksum_t *zcp)
 {
 	const uint32_t *ip = buf;
 	const uint32_t *ipend = ip + (size / sizeof(uint32_t));
+	const uint32_t *ip2 = ip + ((size / sizeof(uint32_t)) & ~1ULL);
+	uint64_t a0, a1, b0, b1, c0, c1, d0, d1;
 	uint64_t a, b, c, d;
 
-	for (a = b = c = d = 0; ip < ipend; ip++) {
+	for (a0 = a1 = b0 = b1 = c0 = c1 = d0 = d1 = 0; ip < ip2; ip += 2) {
+		a0 += zfs_to_cpu32(ip[0], endian);
+		a1 += zfs_to_cpu32(ip[1], endian);
+		b0 += a0;
+		b1 += a1;
+		c0 += b0;
+		c1 += b1;
+		d0 += c0;
+		d1 += c1;
+	}
+
+	a = a0 + a1;
+	b = 2 * (b0 + b1) - a1;
+	c = 4 * (c0 + c1) - b0 - 3 * b1;
+	d = 8 * (d0 + d1) - 4 * c0 - 8 * c1 + b1;
+
+	for (; ip < ipend; ip++) {
 		a += zfs_to_cpu32(ip[0], endian);
 		b += a;
 		c += b;
@@ -139,6 +139,8 @@ struct ahci_ioports {
 	struct ahci_sg		*cmd_tbl_sg;
 	ulong	cmd_tbl;
 	u32	rx_fis;
+	ulong	ncq_tbl;	/* command tables for queued commands */
+	u8	ncq_depth;	/* number of queued commands, 0 if no NCQ */
 };
 
 /**
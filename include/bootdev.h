@@ -77,6 +77,11 @@ typedef int (*bootdev_hunter_func)(struct bootdev_hunter *info, bool show);
  * @uclass: Uclass ID for the media associated with this bootdev
  * @drv: bootdev driver for the things found by this hunter
  * @hunt: Function to call to hunt for bootdevs of this type (NULL if none)
+ * @start: Function to call to start hunting in the background (NULL if none).
+ *	This should start slow hardware, e.g. reset a bus, without waiting for
+ *	it to be ready. It is only used with CONFIG_BOOTSTD_HUNT_AHEAD and must
+ *	not bind any bootdevs. It may be called more than once before @hunt,
+ *	which must still do the full job.
  *
  * Some bootdevs are not visible until other devices are enumerated. For
  * example, USB bootdevs only appear when the USB bus is enumerated.
@@ -93,6 +98,7 @@ struct bootdev_hunter {
 	enum uclass_id uclass;
 	struct driver *drv;
 	bootdev_hunter_func hunt;
+	bootdev_hunter_func start;
 };
 
 /* declare a new bootdev hunter */
@@ -310,6 +316,20 @@ void bootdev_list_hunters(struct bootstd_priv *std);
  */
 int bootdev_hunt(const char *spec, bool show);
 
+/**
+ * bootdev_hunt_ahead() - Start hunters in the background
+ *
+ * This calls the start() method of each hunter which has one and has not been
+ * used yet, so that slow hardware can settle while other bootdevs are scanned.
+ * The hunters are still used in priority order later. The bootstage
+ * 'hunt_ahead' accumulator runs from here until one of the started hunters is
+ * used.
+ *
+ * @labels: List of labels to be scanned, or NULL to start all hunters
+ * @show: true to show each hunter as it is started
+ */
+void bootdev_hunt_ahead(const char *const *labels, bool show);
+
 /**
  * bootdev_hunt_prio() - Hunt for bootdevs of a particular priority
  *
@@ -371,6 +371,38 @@ int bootflow_boot(struct bootflow *bflow);
  */
 int bootflow_read_all(struct bootflow *bflow);
 
+/**
+ * bootflow_cache_save() - Record a bootflow so it can be found quickly later
+ *
+ * This writes the bootdev, partition, bootmeth and filename of @bflow to the
+ * bootflow_cache environment variable, along with the size and CRC32 of the
+ * file. Nothing is written if the record has not changed.
+ *
+ * @bflow: Bootflow which is about to be booted
+ * @save: true to save the environment if the record changed
+ * Return: 0 if OK, -ENOTSUPP if this bootflow cannot be recorded (e.g. it uses
+ *	a global bootmeth), other -ve on error
+ */
+int bootflow_cache_save(const struct bootflow *bflow, bool save);
+
+/**
+ * bootflow_cache_scan() - Find the bootflow recorded by bootflow_cache_save()
+ *
+ * This only looks at the recorded bootdev, partition and bootmeth, so avoids
+ * scanning everything else. The bootflow is only returned if its file still
+ * has the recorded size and CRC32.
+ *
+ * @iter: Place to store private info (inited by this call). This must be
+ *	freed with bootflow_iter_uninit() whatever the result
+ * @flags: Flags for iterator (enum bootflow_iter_flags_t). If
+ *	BOOTFLOWIF_HUNT is set, the hunter for the bootdev is used if needed
+ * @bflow: Returns the bootflow, if found
+ * Return: 0 if found, -ENOENT if there is no record, -ESTALE if the file has
+ *	changed, other -ve on error
+ */
+int bootflow_cache_scan(struct bootflow_iter *iter, int flags,
+			struct bootflow *bflow);
+
 /**
  * bootflow_run_boot() - Try to boot a bootflow
  *
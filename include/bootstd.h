@@ -37,6 +37,11 @@ struct udevice;
  * @theme: Node containing the theme information
  * @hunters_used: Bitmask of used hunters, indexed by their position in the
  * linker list. The bit is set if the hunter has been used already
+ * @hunters_started: Bitmask of hunters started in the background, indexed like
+ * @hunters_used. It is cleared when the scan reaches one of these hunters
+ * @hunt_ahead_us: Time in microseconds for which hunters ran in the background
+ * before the scan reached one of them, or 0 if it has not done so yet (or
+ * bootstage is disabled)
  */
 struct bootstd_priv {
 	const char **prefixes;
@@ -50,6 +55,8 @@ struct bootstd_priv {
 	struct udevice *vbe_bootmeth;
 	ofnode theme;
 	uint hunters_used;
+	uint hunters_started;
+	uint hunt_ahead_us;
 };
 
 /**
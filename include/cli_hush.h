@@ -64,6 +64,11 @@ static inline int set_local_var_modern(char *s, int flg_export)
 }
 #endif
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+/* Get the number of times a script was found in the parse cache */
+unsigned int hush_parse_cache_hits(void);
+#endif
+
 void unset_local_var(const char *name);
 char *get_local_var(const char *s);
 
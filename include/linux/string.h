@@ -116,6 +116,16 @@ extern void * memcpy(void *,const void *,__kernel_size_t);
 #ifndef __HAVE_ARCH_MEMMOVE
 extern void * memmove(void *,const void *,__kernel_size_t);
 #endif
+#if CONFIG_IS_ENABLED(UNIT_TEST)
+/*
+ * The portable versions from lib/string.c, even if the architecture has its
+ * own. These are only for comparing the two in tests.
+ */
+void *memset_generic(void *s, int c, size_t count);
+void *memcpy_generic(void *dest, const void *src, size_t count);
+void *memmove_generic(void *dest, const void *src, size_t count);
+#endif
+
 #ifndef __HAVE_ARCH_MEMSCAN
 extern void * memscan(void *,int,__kernel_size_t);
 #endif
@@ -700,4 +700,65 @@ struct global_data;
  */
 void log_fixup_for_gd_move(struct global_data *new_gd);
 
+#if CONFIG_IS_ENABLED(LOG_CONSOLE_DEFER)
+/**
+ * log_console_defer() - Handle console output while log output is deferred
+ *
+ * This is called for all console output. While the console log driver is
+ * writing a log record, the output is added to the deferred log output.
+ * Otherwise any deferred log output is written out first, so that the order
+ * of the output is kept.
+ *
+ * @s: Output to write (need not be nul-terminated)
+ * @len: Number of bytes in @s
+ * Return: true if @s was added to the deferred output, false if the caller
+ *	should write it out
+ */
+bool log_console_defer(const char *s, int len);
+
+/**
+ * log_console_flush() - Write out all deferred log output
+ */
+void log_console_flush(void);
+
+/**
+ * log_console_pending() - Get the amount of deferred log output
+ *
+ * Return: number of bytes of log output waiting to be written to the console
+ */
+int log_console_pending(void);
+#else
+static inline bool log_console_defer(const char *s, int len)
+{
+	return false;
+}
+
+static inline void log_console_flush(void)
+{
+}
+
+static inline int log_console_pending(void)
+{
+	return 0;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(LOG_RING)
+/**
+ * log_ring_dump() - Show the records held in the log ring buffer
+ *
+ * The records are written to the console, oldest first, using the current
+ * log format
+ *
+ * @count: Number of most recent records to show, or 0 to show them all
+ * Return: number of records shown
+ */
+int log_ring_dump(int count);
+#else
+static inline int log_ring_dump(int count)
+{
+	return 0;
+}
+#endif
+
 #endif
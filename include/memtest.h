@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Block-based memory test engine
+ *
+ * This tests memory a cache line at a time rather than one volatile word
+ * at a time, optionally spreading the work across several CPUs with
+ * parallel_for(). It is used by the 'mtest' command when
+ * CONFIG_SYS_MEMTEST_FAST is enabled.
+ */
+
+#ifndef __MEMTEST_H
+#define __MEMTEST_H
+
+#include <linux/types.h>
+
+/**
+ * enum memtest_t - Available memory tests
+ *
+ * @MEMTEST_ADDR_BITS: Walking-ones test on the address lines, checking for
+ *	address bits which are stuck high, stuck low or shorted
+ * @MEMTEST_MOVING_INV: Moving inversions: fill with a pattern, then check
+ *	and invert each word ascending, then check and restore descending
+ * @MEMTEST_OWN_ADDR: Write each word with its own address (XORed with the
+ *	pattern), then check it
+ * @MEMTEST_COUNT: Number of tests
+ */
+enum memtest_t {
+	MEMTEST_ADDR_BITS,
+	MEMTEST_MOVING_INV,
+	MEMTEST_OWN_ADDR,
+
+	MEMTEST_COUNT,
+};
+
+/**
+ * struct memtest_result - Result of running a memory test
+ *
+ * @errors: Number of words which did not read back correctly
+ * @fail_addr: Address of the first failure found (valid if @errors != 0)
+ * @expected: Value expected at @fail_addr
+ * @actual: Value read from @fail_addr
+ * @bytes: Total number of bytes written and read by the test
+ * @time_us: Time taken by the test in microseconds
+ */
+struct memtest_result {
+	ulong errors;
+	ulong fail_addr;
+	ulong expected;
+	ulong actual;
+	u64 bytes;
+	ulong time_us;
+};
+
+/**
+ * memtest_name() - Get the name of a memory test
+ *
+ * @test: Test to check
+ * Return: name of test, or "unknown" if not valid
+ */
+const char *memtest_name(enum memtest_t test);
+
+/**
+ * memtest_run() - Run a memory test on a region
+ *
+ * The region is split into chunks which are tested on all available CPUs.
+ * Failures are counted and the one at the lowest address is recorded.
+ *
+ * @test: Test to run
+ * @buf: Pointer to the start of the region
+ * @start_addr: Address of the start of the region, used for reporting
+ *	and for MEMTEST_OWN_ADDR
+ * @size: Size of the region in bytes; this is rounded down to a multiple
+ *	of sizeof(ulong)
+ * @pattern: Pattern to use for the test
+ * @res: Returns the result of the test
+ * Return: 0 if the test ran (check @res->errors for failures), -EINVAL if
+ *	@test is not valid, other -ve on error
+ */
+int memtest_run(enum memtest_t test, void *buf, ulong start_addr, ulong size,
+		ulong pattern, struct memtest_result *res);
+
+/**
+ * memtest_bandwidth() - Get the bandwidth achieved by a test
+ *
+ * @res: Result of the test
+ * Return: bandwidth in MB/s (1MB = 1 << 20 bytes), 0 if unknown
+ */
+ulong memtest_bandwidth(const struct memtest_result *res);
+
+/**
+ * typedef memtest_hook_t - Function called after each pass over the region
+ *
+ * @buf: Start of the region being tested
+ * @pass: Pass which has just completed, counting from 0
+ */
+typedef void (*memtest_hook_t)(ulong *buf, int pass);
+
+/**
+ * memtest_set_hook() - Set a function to call after each pass
+ *
+ * This allows tests to corrupt the region between passes, to check that
+ * errors are found and reported. It is only available with CONFIG_UNIT_TEST
+ *
+ * @hook: Function to call, or NULL for none
+ */
+void memtest_set_hook(memtest_hook_t hook);
+
+#endif
@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Apply device tree overlays using a live (hierarchical) tree
+ */
+
+#ifndef _OF_OVERLAY_H
+#define _OF_OVERLAY_H
+
+#include <linux/types.h>
+
+struct device_node;
+struct of_overlay_mem;
+struct of_overlay_slot;
+
+/**
+ * struct of_overlay_hash - Hash table used to look up nodes and symbols
+ *
+ * @slots: Table entries, each holding a hash value and an item pointer, or
+ *	NULL if the table is empty
+ * @size: Number of entries in @slots (a power of two)
+ * @count: Number of entries used in @slots
+ */
+struct of_overlay_hash {
+	struct of_overlay_slot *slots;
+	uint size;
+	uint count;
+};
+
+/**
+ * struct of_overlay_ctx - State for applying overlays to a live tree
+ *
+ * The flat base tree is expanded once by of_overlay_start(), any number of
+ * overlays are merged into the expanded tree with of_overlay_add() and the
+ * result is written out once by of_overlay_finish(). This avoids moving the
+ * tail of the flat tree around for every property and node that an overlay
+ * adds, which gets expensive when many overlays are applied to a large tree.
+ *
+ * @fdt: Flat base tree; this must not change until of_overlay_finish()
+ * @root: Root of the live tree built from @fdt
+ * @max_phandle: Largest phandle in the tree
+ * @symbols: /__symbols__ node, or NULL if none
+ * @phandles: Nodes by phandle
+ * @paths: Nodes by full path
+ * @labels: /__symbols__ properties by name; this is empty until an overlay
+ *	refers to a symbol
+ * @mem: List of allocations made for the tree and the overlays
+ */
+struct of_overlay_ctx {
+	void *fdt;
+	struct device_node *root;
+	u32 max_phandle;
+	struct device_node *symbols;
+	struct of_overlay_hash phandles;
+	struct of_overlay_hash paths;
+	struct of_overlay_hash labels;
+	struct of_overlay_mem *mem;
+};
+
+/**
+ * of_overlay_start() - Start applying overlays to a flat tree
+ *
+ * @ctx: Context to set up
+ * @fdt: Base tree. The live tree refers to data in this, so it must not be
+ *	changed until of_overlay_finish() is called
+ * Return: 0 if OK, -EINVAL if @fdt is not valid, -ENOMEM if out of memory
+ */
+int of_overlay_start(struct of_overlay_ctx *ctx, void *fdt);
+
+/**
+ * of_overlay_add() - Merge an overlay into the live tree
+ *
+ * This behaves like fdt_overlay_apply(), but @fdto is not changed, so the
+ * caller does not need to make a copy of it first. Overlays added later may
+ * refer to symbols added by earlier ones.
+ *
+ * @ctx: Context set up by of_overlay_start()
+ * @fdto: Overlay to apply
+ * Return: 0 if OK, -EINVAL if the overlay is not valid, -ENOENT if a target
+ *	node or symbol was not found, -ERANGE if phandles overflow, -ENOMEM if
+ *	out of memory
+ */
+int of_overlay_add(struct of_overlay_ctx *ctx, const void *fdto);
+
+/**
+ * of_overlay_finish() - Write the live tree back out as a flat tree
+ *
+ * The memory-reservation block and boot CPU of the original base tree are
+ * kept. The resulting tree is packed.
+ *
+ * @ctx: Context set up by of_overlay_start()
+ * @fdt: Place to write the tree; this may be the original base tree
+ * @size: Size of space at @fdt
+ * Return: 0 if OK, -ENOSPC if the tree does not fit in @size bytes, -ENOMEM
+ *	if out of memory
+ */
+int of_overlay_finish(struct of_overlay_ctx *ctx, void *fdt, int size);
+
+/**
+ * of_overlay_uninit() - Free memory used by an overlay context
+ *
+ * This must be called once done with @ctx, whether of_overlay_finish() was
+ * called or not
+ *
+ * @ctx: Context to free
+ */
+void of_overlay_uninit(struct of_overlay_ctx *ctx);
+
+#endif
@@ -548,4 +548,20 @@ long os_get_time_offset(void);
  */
 void os_set_time_offset(long offset);
 
+/**
+ * os_run_parallel() - run a function on several host threads
+ *
+ * The calling thread runs @func as CPU 0 and @nr_threads - 1 other threads
+ * are started for the remaining CPUs. This returns once all of them have
+ * finished. If some threads cannot be created, the work is simply shared
+ * among fewer threads, so @func must not rely on a particular thread count.
+ *
+ * @nr_threads:	number of threads to use, including the calling one
+ * @func:	function to run, passed @ctx and the thread number
+ * @ctx:	context pointer for @func
+ * Return:	0 if OK, -ve on error
+ */
+int os_run_parallel(int nr_threads, void (*func)(void *ctx, int cpu),
+		    void *ctx);
+
 #endif
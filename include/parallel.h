@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Simple work sharing across the CPUs available to U-Boot
+ *
+ * U-Boot normally runs on a single CPU and parks the others. For a few
+ * bulk operations (memory tests, hashing, clearing large regions) it is
+ * worth handing parts of the work to the secondary CPUs. This provides a
+ * parallel_for() which splits a range into chunks which are claimed by
+ * each CPU in turn, using a single atomic counter so that no locks are
+ * needed.
+ *
+ * The work function runs without the usual U-Boot environment on secondary
+ * CPUs: it must not call printf(), malloc(), driver model or anything else
+ * which is not safe to run concurrently. It should stick to operating on
+ * memory passed in through its private pointer.
+ */
+
+#ifndef __PARALLEL_H
+#define __PARALLEL_H
+
+#include <errno.h>
+#include <linux/kernel.h>
+#include <linux/types.h>
+
+/**
+ * typedef par_func_t - Function called to process part of a range
+ *
+ * @priv: Private data passed to parallel_for()
+ * @start: First item to process
+ * @end: Item after the last one to process
+ * @cpu: CPU number running this chunk (0 is the boot CPU)
+ */
+typedef void (*par_func_t)(void *priv, ulong start, ulong end, int cpu);
+
+#if CONFIG_IS_ENABLED(PARALLEL)
+/**
+ * parallel_num_cpus() - Get the number of CPUs that can run work
+ *
+ * Return: number of CPUs, always at least 1
+ */
+int parallel_num_cpus(void);
+
+/**
+ * parallel_for() - Process a range of items on all available CPUs
+ *
+ * The range [0, @count) is split into chunks of @grain items (the last
+ * one may be smaller). Each CPU claims chunks until there are none left.
+ * This returns once all chunks have been processed.
+ *
+ * If parallel execution is not supported or not enabled, all the work is
+ * done on the calling CPU.
+ *
+ * @count: Number of items to process
+ * @grain: Number of items in each chunk, must be non-zero
+ * @func: Function to call for each chunk
+ * @priv: Private data to pass to @func
+ * Return: 0 if OK, -EINVAL if @grain is 0, other -ve on error
+ */
+int parallel_for(ulong count, ulong grain, par_func_t func, void *priv);
+#else
+static inline int parallel_num_cpus(void)
+{
+	return 1;
+}
+
+static inline int parallel_for(ulong count, ulong grain, par_func_t func,
+			       void *priv)
+{
+	ulong start;
+
+	if (!grain)
+		return -EINVAL;
+	for (start = 0; start < count; start += grain)
+		func(priv, start, start + min(grain, count - start), 0);
+
+	return 0;
+}
+#endif
+
+/**
+ * arch_parallel_num_cpus() - Get the number of CPUs the arch can use
+ *
+ * This is a weak function which returns 1 by default
+ *
+ * Return: number of CPUs that arch_parallel_run() can use
+ */
+int arch_parallel_num_cpus(void);
+
+/**
+ * arch_parallel_run() - Run a function on several CPUs
+ *
+ * Runs @func on the calling CPU (as CPU 0) and on @nr_cpus - 1 secondary
+ * CPUs, returning once all have finished. This must either run @func on at
+ * least the calling CPU or return an error without running it at all.
+ *
+ * This is a weak function which returns -ENOSYS by default
+ *
+ * @nr_cpus: Number of CPUs to use
+ * @func: Function to run, passed @ctx and the CPU number
+ * @ctx: Context pointer for @func
+ * Return: 0 if OK, -ENOSYS if not supported, other -ve on error
+ */
+int arch_parallel_run(int nr_cpus, void (*func)(void *ctx, int cpu),
+		      void *ctx);
+
+#endif
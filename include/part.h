@@ -623,6 +623,19 @@ int gpt_verify_partitions(struct blk_desc *desc,
  */
 int get_disk_guid(struct blk_desc *desc, char *guid);
 
+/**
+ * gpt_cache_invalidate() - Drop the cached GPT for a block device
+ *
+ * The GPT last found is kept so that looking up each partition of a device in
+ * turn does not read the partition entries every time. This must be called
+ * when the device is written or set up again.
+ *
+ * @desc:	block device descriptor
+ */
+void gpt_cache_invalidate(struct blk_desc *desc);
+
+#else
+static inline void gpt_cache_invalidate(struct blk_desc *desc) {}
 #endif
 
 #if CONFIG_IS_ENABLED(DOS_PARTITION)
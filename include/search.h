@@ -47,6 +47,16 @@ struct hsearch_data {
 	struct env_entry_node *table;
 	unsigned int size;
 	unsigned int filled;
+	/* number of deleted slots, which still slow down searches */
+	unsigned int deleted;
+	/* non-zero while a callback is running, so the table cannot move */
+	int busy;
+	/*
+	 * Entries in key order, as used by the last full hexport_r(). This is
+	 * dropped when a key is added or removed.
+	 */
+	struct env_entry **sorted;
+	unsigned int nsorted;
 /*
  * Callback function which will check whether the given change for variable
  * "item" to "newval" may be applied or not, and possibly apply such change.
@@ -64,6 +64,17 @@ void rsa_free_key_prop(struct key_prop *prop);
 int rsa_mod_exp_sw(const uint8_t *sig, uint32_t sig_len,
 		struct key_prop *node, uint8_t *out);
 
+/**
+ * rsa_mod_exp_set_32bit() - Select the 32-bit code for rsa_mod_exp_sw()
+ *
+ * Where the compiler supports it, rsa_mod_exp_sw() works in 64-bit words.
+ * This allows tests to check the 32-bit code on such machines too.
+ *
+ * @force:	true to always use 32-bit words, false to use 64-bit words
+ *		where possible
+ */
+void rsa_mod_exp_set_32bit(bool force);
+
 int rsa_mod_exp(struct udevice *dev, const uint8_t *sig, uint32_t sig_len,
 		struct key_prop *node, uint8_t *out);
 
@@ -271,6 +271,17 @@ int usb_kbd_deregister(int force);
  */
 int usb_init(void);
 
+/*
+ * usb_init_controllers() - probe the USB controllers without scanning them
+ *
+ * This allows the controllers and their ports to power up while other work is
+ * done. It does nothing if the controllers have already been probed. It is
+ * called by usb_init() if needed, which then scans the buses.
+ *
+ * Returns: 0 if OK, -ve on error
+ */
+int usb_init_controllers(void);
+
 int usb_stop(void); /* stop the USB Controller */
 int usb_detect_change(void); /* detect if a USB device has been (un)plugged */
 
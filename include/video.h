@@ -73,6 +73,23 @@ enum video_format {
 	VIDEO_X2R10G10B10,
 };
 
+/**
+ * struct vid_bbox - Bounding box of a region of the display
+ *
+ * The region is empty if @x0 >= @x1 or @y0 >= @y1
+ *
+ * @x0: X start position in pixels from the left
+ * @y0: Y start position in pixels from the top
+ * @x1: X end position in pixels from the left (exclusive)
+ * @y1: Y end position in pixels from the top (exclusive)
+ */
+struct vid_bbox {
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+};
+
 /**
  * struct video_priv - Device information used by the video uclass
  *
@@ -97,6 +114,10 @@ enum video_format {
  *		the LCD is updated
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
+ * @damage:	Region of the frame buffer which has changed since the last
+ *		call to video_sync(), if CONFIG_VIDEO_DAMAGE is enabled. The
+ *		video_sync() method in struct video_ops can use this to avoid
+ *		sending the whole frame buffer to the display
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -121,6 +142,7 @@ struct video_priv {
 	bool flush_dcache;
 	u8 fg_col_idx;
 	u8 bg_col_idx;
+	struct vid_bbox damage;
 };
 
 /**
@@ -129,7 +151,9 @@ struct video_priv {
  *		displays needs synchronization when data in an FB is available.
  *		For these devices implement video_sync hook to call a sync
  *		function. vid is pointer to video device udevice. Function
- *		should return 0 on success video_sync and error code otherwise
+ *		should return 0 on success video_sync and error code otherwise.
+ *		With CONFIG_VIDEO_DAMAGE the region to sync is given by @damage
+ *		in struct video_priv
  */
 struct video_ops {
 	int (*video_sync)(struct udevice *vid);
@@ -341,12 +365,35 @@ void video_set_default_colors(struct udevice *dev, bool invert);
  */
 int video_default_font_height(struct udevice *dev);
 
-#ifdef CONFIG_VIDEO_COPY
+#ifdef CONFIG_VIDEO_DAMAGE
+/**
+ * video_damage() - Mark a region of the frame buffer as changed
+ *
+ * The region is clipped to the display and added to the region which is
+ * synced by the next call to video_sync(). Callers which use
+ * video_sync_copy() do not need to call this.
+ *
+ * @vid:	Video device
+ * @x:		X start position in pixels from the left
+ * @y:		Y start position in pixels from the top
+ * @width:	Width of the region in pixels
+ * @height:	Height of the region in pixels
+ */
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+#else
+static inline void video_damage(struct udevice *vid, int x, int y, int width,
+				int height)
+{
+}
+#endif
+
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 /**
  * vidconsole_sync_copy() - Sync back to the copy framebuffer
  *
  * This ensures that the copy framebuffer has the same data as the framebuffer
- * for a particular region. It should be called after the framebuffer is updated
+ * for a particular region. It should be called after the framebuffer is
+ * updated. With CONFIG_VIDEO_DAMAGE it also records the region as changed.
  *
  * @from and @to can be in either order. The region between them is synced.
  *
@@ -529,7 +529,17 @@ void vidconsole_list_fonts(struct udevice *dev);
  */
 int vidconsole_get_font_size(struct udevice *dev, const char **name, uint *sizep);
 
-#ifdef CONFIG_VIDEO_COPY
+/**
+ * console_truetype_set_cache() - Enable or disable the TrueType glyph cache
+ *
+ * This allows tests to compare cached glyphs against freshly rendered ones. It
+ * is only available with CONFIG_UNIT_TEST
+ *
+ * @enable: true to use the glyph cache, false to render every glyph each time
+ */
+void console_truetype_set_cache(bool enable);
+
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 /**
  * vidconsole_sync_copy() - Sync back to the copy framebuffer
  *
@@ -15,6 +15,10 @@
  * On-disk version number.
  */
 #define	SPA_VERSION			28ULL
+#define	SPA_VERSION_FEATURES		5000ULL
+
+#define	SPA_VERSION_IS_SUPPORTED(v)				\
+	(((v) >= 1 && (v) <= SPA_VERSION) || (v) == SPA_VERSION_FEATURES)
 
 /*
  * The following are configuration names used in the nvlist describing a pool's
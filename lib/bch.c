@@ -104,6 +104,19 @@
 #define BCH_ECC_WORDS(_p)      DIV_ROUND_UP(GF_M(_p)*GF_T(_p), 32)
 #define BCH_ECC_BYTES(_p)      DIV_ROUND_UP(GF_M(_p)*GF_T(_p), 8)
 
+/* marks a zero entry in syn_tab, which has no log */
+#define BCH_SYN_NONE           0xffff
+
+/*
+ * syn_tab takes 512 bytes per correctable bit, which is too much for the small
+ * SPL heap, so SPL computes syndromes one ecc bit at a time instead
+ */
+#ifdef CONFIG_SPL_BUILD
+#define BCH_SYN_TABLES         0
+#else
+#define BCH_SYN_TABLES         1
+#endif
+
 #ifndef dbg
 #define dbg(_fmt, args...)     do {} while (0)
 #endif
@@ -382,14 +395,21 @@ static inline int a_ilog(struct bch_control *bch, unsigned int x)
 
 /*
  * compute 2t syndromes of ecc polynomial, i.e. ecc(a^j) for j=1..2t
+ *
+ * The odd syndromes are computed one ecc byte at a time: syn_tab gives, for
+ * each byte value, the log of its contribution at the lowest position and
+ * syn_pos gives the log of the factor needed to move it to its real position.
+ * Without these tables, each set bit of the ecc is handled on its own.
  */
 static void compute_syndromes(struct bch_control *bch, uint32_t *ecc,
 			      unsigned int *syn)
 {
 	int i, j, s;
-	unsigned int m;
+	unsigned int m, v;
 	uint32_t poly;
 	const int t = GF_T(bch);
+	const int nbytes = DIV_ROUND_UP(bch->ecc_bits, 8);
+	const uint16_t *tab, *pos;
 
 	s = bch->ecc_bits;
 
@@ -400,17 +420,31 @@ static void compute_syndromes(struct bch_control *bch, uint32_t *ecc,
 	memset(syn, 0, 2*t*sizeof(*syn));
 
 	/* compute v(a^j) for j=1 .. 2t-1 */
-	do {
-		poly = *ecc++;
-		s -= 32;
-		while (poly) {
-			i = deg(poly);
-			for (j = 0; j < 2*t; j += 2)
-				syn[j] ^= a_pow(bch, (j+1)*(i+s));
-
-			poly ^= (1 << i);
-		}
-	} while (s > 0);
+	if (!BCH_SYN_TABLES) {
+		do {
+			poly = *ecc++;
+			s -= 32;
+			while (poly) {
+				i = deg(poly);
+				for (j = 0; j < 2*t; j += 2)
+					syn[j] ^= a_pow(bch, (j+1)*(i+s));
+
+				poly ^= (1 << i);
+			}
+		} while (s > 0);
+	}
+
+	for (i = 0; BCH_SYN_TABLES && i < nbytes; i++) {
+		v = (ecc[i/4] >> (24-8*(i & 3))) & 0xff;
+		if (!v)
+			continue;
+		tab = bch->syn_tab+v*t;
+		pos = bch->syn_pos+i*t;
+		for (j = 0; j < t; j++)
+			if (tab[j] != BCH_SYN_NONE)
+				syn[2*j] ^= bch->a_pow_tab[mod_s(bch, tab[j]+
+								 pos[j])];
+	}
 
 	/* v(a^(2j)) = v(a^j)^2 */
 	for (j = 0; j < t; j++)
@@ -1060,16 +1094,22 @@ int decode_bch(struct bch_control *bch, const uint8_t *data, unsigned int len,
 		if (recv_ecc) {
 			load_ecc8(bch, bch->ecc_buf2, recv_ecc);
 			/* XOR received and calculated ecc */
-			for (i = 0, sum = 0; i < (int)ecc_words; i++) {
+			for (i = 0; i < (int)ecc_words; i++)
 				bch->ecc_buf[i] ^= bch->ecc_buf2[i];
-				sum |= bch->ecc_buf[i];
-			}
-			if (!sum)
-				/* no error found */
-				return 0;
 		}
+		for (i = 0, sum = 0; i < (int)ecc_words; i++)
+			sum |= bch->ecc_buf[i];
+		if (!sum)
+			/* no error found */
+			return 0;
 		compute_syndromes(bch, bch->ecc_buf, bch->syn);
 		syn = bch->syn;
+	} else {
+		/* all-zero syndromes also mean that no error was found */
+		for (i = 0, sum = 0; i < 2*(int)GF_T(bch); i++)
+			sum |= syn[i];
+		if (!sum)
+			return 0;
 	}
 
 	err = compute_error_locator_polynomial(bch, syn);
@@ -1155,6 +1195,37 @@ static void build_mod8_tables(struct bch_control *bch, const uint32_t *g)
 	}
 }
 
+/*
+ * build tables for computing syndromes one ecc byte at a time
+ */
+static void build_syn_tables(struct bch_control *bch)
+{
+	int i, j, b;
+	unsigned int v, base;
+	const int t = GF_T(bch);
+	const int nbytes = DIV_ROUND_UP(bch->ecc_bits, 8);
+
+	/* log of sum of a^((2j+1)*b) over bits b set in byte value i */
+	for (i = 0; i < 256; i++) {
+		for (j = 0; j < t; j++) {
+			for (b = 0, v = 0; b < 8; b++)
+				if (i & (1 << b))
+					v ^= a_pow(bch, (2*j+1)*b);
+			bch->syn_tab[i*t+j] = v ? a_log(bch, v) : BCH_SYN_NONE;
+		}
+	}
+
+	/*
+	 * bit 0 of ecc byte i is the coefficient of X^(ecc_bits-8*(i+1)), which
+	 * is negative for a partial last byte; its low bits are zero then
+	 */
+	for (i = 0; i < nbytes; i++) {
+		base = GF_N(bch)+bch->ecc_bits-8*(i+1);
+		for (j = 0; j < t; j++)
+			bch->syn_pos[i*t+j] = modulo(bch, (2*j+1)*base);
+	}
+}
+
 /*
  * build a base for factoring degree 2 polynomials
  */
@@ -1354,6 +1425,12 @@ struct bch_control *init_bch(int m, int t, unsigned int prim_poly)
 	bch->cache     = bch_alloc(2*t*sizeof(*bch->cache), &err);
 	bch->elp       = bch_alloc((t+1)*sizeof(struct gf_poly_deg1), &err);
 
+	if (BCH_SYN_TABLES) {
+		bch->syn_tab = bch_alloc(256*t*sizeof(*bch->syn_tab), &err);
+		bch->syn_pos = bch_alloc(bch->ecc_bytes*t*
+					 sizeof(*bch->syn_pos), &err);
+	}
+
 	for (i = 0; i < ARRAY_SIZE(bch->poly_2t); i++)
 		bch->poly_2t[i] = bch_alloc(GF_POLY_SZ(2*t), &err);
 
@@ -1372,6 +1449,9 @@ struct bch_control *init_bch(int m, int t, unsigned int prim_poly)
 	build_mod8_tables(bch, genpoly);
 	kfree(genpoly);
 
+	if (BCH_SYN_TABLES)
+		build_syn_tables(bch);
+
 	err = build_deg2_base(bch);
 	if (err)
 		goto fail;
@@ -1399,6 +1479,8 @@ void free_bch(struct bch_control *bch)
 		kfree(bch->ecc_buf2);
 		kfree(bch->xi_tab);
 		kfree(bch->syn);
+		kfree(bch->syn_tab);
+		kfree(bch->syn_pos);
 		kfree(bch->cache);
 		kfree(bch->elp);
 
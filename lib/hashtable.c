@@ -53,15 +53,117 @@
  * which describes the current status.
  */
 
+/*
+ * The key and data of each entry are held in a single allocation, with the
+ * data immediately following the key's terminator. data_size is the space
+ * available for the data (including its terminator), so that an overwrite
+ * with a value which fits can be done in place.
+ */
 struct env_entry_node {
 	int used;
+	unsigned int data_size;
 	struct env_entry entry;
 };
 
+/* Data space is allocated in multiples of this, to allow values to grow */
+#define DATA_ALIGN	16
+
+/*
+ * The table is grown once the number of entries (including deleted ones,
+ * which still lengthen the probe sequences) reaches this fraction of its
+ * size, in percent.
+ */
+#define MAX_LOAD_PCT	75
 
 static void _hdelete(const char *key, struct hsearch_data *htab,
 		     struct env_entry *ep, int idx);
 
+/* Drop the cached export order, e.g. because the set of keys changed */
+static void hsort_invalidate(struct hsearch_data *htab)
+{
+	free(htab->sorted);
+	htab->sorted = NULL;
+	htab->nsorted = 0;
+}
+
+/*
+ * Set up the key and data of a new entry in a single allocation. Returns 0
+ * if OK, -ENOMEM if out of memory.
+ */
+static int entry_alloc(struct env_entry_node *node, const char *key,
+		       const char *data)
+{
+	size_t key_len = strlen(key) + 1;
+	size_t data_len = strlen(data) + 1;
+	size_t data_size = (data_len + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1);
+	char *buf;
+
+	buf = malloc(key_len + data_size);
+	if (!buf)
+		return -ENOMEM;
+	memcpy(buf, key, key_len);
+	memcpy(buf + key_len, data, data_len);
+	node->entry.key = buf;
+	node->entry.data = buf + key_len;
+	node->data_size = data_size;
+
+	return 0;
+}
+
+/*
+ * Replace the data of an existing entry, in place if it fits. Returns 0 if
+ * OK, -ENOMEM if out of memory, in which case the entry is unchanged.
+ */
+static int entry_set_data(struct env_entry_node *node, const char *data)
+{
+	size_t data_len = strlen(data) + 1;
+	size_t key_len, data_size;
+	char *buf;
+
+	if (data_len <= node->data_size) {
+		/* the new value may be part of the old one, so use memmove */
+		memmove(node->entry.data, data, data_len);
+		return 0;
+	}
+
+	key_len = strlen(node->entry.key) + 1;
+	data_size = (data_len + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1);
+	buf = malloc(key_len + data_size);
+	if (!buf)
+		return -ENOMEM;
+	memcpy(buf, node->entry.key, key_len);
+	memcpy(buf + key_len, data, data_len);
+	free((void *)node->entry.key);
+	node->entry.key = buf;
+	node->entry.data = buf + key_len;
+	node->data_size = data_size;
+
+	return 0;
+}
+
+static void entry_free(struct env_entry_node *node)
+{
+	/* the data is part of the same allocation */
+	free((void *)node->entry.key);
+	node->entry.key = NULL;
+	node->entry.data = NULL;
+	node->data_size = 0;
+}
+
+/* Compute the raw hash value of a key */
+static unsigned int hash_key(const char *key)
+{
+	unsigned int count = strlen(key);
+	unsigned int hval = count;
+
+	while (count-- > 0) {
+		hval <<= 4;
+		hval += key[count];
+	}
+
+	return hval;
+}
+
 /*
  * hcreate()
  */
@@ -84,6 +186,16 @@ static int isprime(unsigned int number)
 	return number % div != 0;
 }
 
+/* Get the first prime number not smaller than @nel */
+static size_t next_prime(size_t nel)
+{
+	nel |= 1;		/* make odd */
+	while (!isprime(nel))
+		nel += 2;
+
+	return nel;
+}
+
 /*
  * Before using the hash table we must allocate memory for it.
  * Test for an existing table are done. We allocate one element
@@ -108,12 +220,14 @@ int hcreate_r(size_t nel, struct hsearch_data *htab)
 	}
 
 	/* Change nel to the first prime number not smaller as nel. */
-	nel |= 1;		/* make odd */
-	while (!isprime(nel))
-		nel += 2;
+	nel = next_prime(nel);
 
 	htab->size = nel;
 	htab->filled = 0;
+	htab->deleted = 0;
+	htab->busy = 0;
+	htab->sorted = NULL;
+	htab->nsorted = 0;
 
 	/* allocate memory and zero out */
 	htab->table = (struct env_entry_node *)calloc(htab->size + 1,
@@ -149,14 +263,11 @@ void hdestroy_r(struct hsearch_data *htab)
 
 	/* free used memory */
 	for (i = 1; i <= htab->size; ++i) {
-		if (htab->table[i].used > 0) {
-			struct env_entry *ep = &htab->table[i].entry;
-
-			free((void *)ep->key);
-			free(ep->data);
-		}
+		if (htab->table[i].used > 0)
+			entry_free(&htab->table[i]);
 	}
 	free(htab->table);
+	hsort_invalidate(htab);
 
 	/* the sign for an existing table is an value != NULL in htable */
 	htab->table = NULL;
@@ -219,17 +330,125 @@ int hmatch_r(const char *match, int last_idx, struct env_entry **retval,
 	return 0;
 }
 
+/*
+ * Callbacks may set other variables. While one is running, the table must
+ * not be resized, since the caller still refers to an entry by its index.
+ */
 static int
-do_callback(const struct env_entry *e, const char *name, const char *value,
-	    enum env_op op, int flags)
+do_callback(struct hsearch_data *htab, const struct env_entry *e,
+	    const char *name, const char *value, enum env_op op, int flags)
 {
+	int ret = 0;
+
 #ifndef CONFIG_SPL_BUILD
-	if (e->callback)
-		return e->callback(name, value, op, flags);
+	if (e->callback) {
+		htab->busy++;
+		ret = e->callback(name, value, op, flags);
+		htab->busy--;
+	}
 #endif
+	return ret;
+}
+
+static int call_change_ok(struct hsearch_data *htab, const struct env_entry *e,
+			  const char *newval, enum env_op op, int flag)
+{
+	int ret;
+
+	if (!htab->change_ok)
+		return 0;
+	htab->busy++;
+	ret = htab->change_ok(e, newval, op, flag);
+	htab->busy--;
+
+	return ret;
+}
+
+/*
+ * Find a free slot for a key with the given hash value, using the same
+ * probe sequence as hsearch_r(). The table must have at least one free
+ * slot. Returns the index and sets *hvalp to the value to store in 'used'.
+ */
+static unsigned int hprobe_free(struct env_entry_node *table,
+				unsigned int size, unsigned int hash,
+				unsigned int *hvalp)
+{
+	unsigned int hval, hval2, idx;
+
+	hval = hash % size;
+	if (hval == 0)
+		++hval;
+	*hvalp = hval;
+	idx = hval;
+	if (table[idx].used == USED_FREE)
+		return idx;
+
+	hval2 = 1 + hval % (size - 2);
+	do {
+		if (idx <= hval2)
+			idx = size + idx - hval2;
+		else
+			idx -= hval2;
+	} while (table[idx].used != USED_FREE);
+
+	return idx;
+}
+
+/*
+ * Move all entries to a new table of (at least) nel slots. This also drops
+ * any deleted entries. The key and data of each entry stay where they are,
+ * but pointers to struct env_entry are no longer valid afterwards.
+ */
+static int hresize(struct hsearch_data *htab, size_t nel)
+{
+	struct env_entry_node *old = htab->table;
+	unsigned int old_size = htab->size;
+	struct env_entry_node *table;
+	unsigned int size, hval, idx, i;
+
+	size = next_prime(nel);
+	table = calloc(size + 1, sizeof(struct env_entry_node));
+	if (!table)
+		return -ENOMEM;
+
+	for (i = 1; i <= old_size; i++) {
+		if (old[i].used <= 0)
+			continue;
+		idx = hprobe_free(table, size, hash_key(old[i].entry.key),
+				  &hval);
+		table[idx] = old[i];
+		table[idx].used = hval;
+	}
+	debug("hresize: %u -> %u entries, %u used\n", old_size, size,
+	      htab->filled);
+
+	htab->table = table;
+	htab->size = size;
+	htab->deleted = 0;
+	free(old);
+	hsort_invalidate(htab);
+
 	return 0;
 }
 
+/*
+ * Grow the table if it is getting too full to be searched quickly. If
+ * there are many deleted entries it is rebuilt at the same size instead.
+ * Failure is not fatal, since the existing table can still be used.
+ */
+static void hgrow(struct hsearch_data *htab)
+{
+	unsigned int used = htab->filled + htab->deleted + 1;
+
+	if (htab->busy || used * 100 <= htab->size * MAX_LOAD_PCT)
+		return;
+
+	if ((htab->filled + 1) * 100 > htab->size * MAX_LOAD_PCT / 2)
+		hresize(htab, (size_t)htab->size * 2);
+	else
+		hresize(htab, htab->size);
+}
+
 /*
  * Compare an existing entry with the desired key, and overwrite if the action
  * is ENV_ENTER.  This is simply a helper function for hsearch_r().
@@ -244,9 +463,8 @@ static inline int _compare_and_overwrite_entry(struct env_entry item,
 		/* Overwrite existing value? */
 		if (action == ENV_ENTER && item.data) {
 			/* check for permission */
-			if (htab->change_ok != NULL && htab->change_ok(
-			    &htab->table[idx].entry, item.data,
-			    env_op_overwrite, flag)) {
+			if (call_change_ok(htab, &htab->table[idx].entry,
+					   item.data, env_op_overwrite, flag)) {
 				debug("change_ok() rejected setting variable "
 					"%s, skipping it!\n", item.key);
 				__set_errno(EPERM);
@@ -255,7 +473,7 @@ static inline int _compare_and_overwrite_entry(struct env_entry item,
 			}
 
 			/* If there is a callback, call it */
-			if (do_callback(&htab->table[idx].entry, item.key,
+			if (do_callback(htab, &htab->table[idx].entry, item.key,
 					item.data, env_op_overwrite, flag)) {
 				debug("callback() rejected setting variable "
 					"%s, skipping it!\n", item.key);
@@ -264,9 +482,7 @@ static inline int _compare_and_overwrite_entry(struct env_entry item,
 				return 0;
 			}
 
-			free(htab->table[idx].entry.data);
-			htab->table[idx].entry.data = strdup(item.data);
-			if (!htab->table[idx].entry.data) {
+			if (entry_set_data(&htab->table[idx], item.data)) {
 				__set_errno(ENOMEM);
 				*retval = NULL;
 				return 0;
@@ -284,25 +500,19 @@ int hsearch_r(struct env_entry item, enum env_action action,
 	      struct env_entry **retval, struct hsearch_data *htab, int flag)
 {
 	unsigned int hval;
-	unsigned int count;
-	unsigned int len = strlen(item.key);
 	unsigned int idx;
 	unsigned int first_deleted = 0;
 	int ret;
 
-	/* Compute an value for the given string. Perhaps use a better method. */
-	hval = len;
-	count = len;
-	while (count-- > 0) {
-		hval <<= 4;
-		hval += item.key[count];
-	}
+	/* Make room first, since this moves the entries */
+	if (action == ENV_ENTER)
+		hgrow(htab);
 
 	/*
 	 * First hash function:
 	 * simply take the modul but prevent zero.
 	 */
-	hval %= htab->size;
+	hval = hash_key(item.key) % htab->size;
 	if (hval == 0)
 		++hval;
 
@@ -374,22 +584,24 @@ int hsearch_r(struct env_entry item, enum env_action action,
 
 		/*
 		 * Create new entry;
-		 * create copies of item.key and item.data
+		 * create a copy of item.key and item.data
 		 */
-		if (first_deleted)
+		if (first_deleted) {
 			idx = first_deleted;
+			--htab->deleted;
+		}
 
-		htab->table[idx].used = hval;
-		htab->table[idx].entry.key = strdup(item.key);
-		htab->table[idx].entry.data = strdup(item.data);
-		if (!htab->table[idx].entry.key ||
-		    !htab->table[idx].entry.data) {
+		if (entry_alloc(&htab->table[idx], item.key, item.data)) {
+			if (first_deleted)
+				++htab->deleted;
 			__set_errno(ENOMEM);
 			*retval = NULL;
 			return 0;
 		}
+		htab->table[idx].used = hval;
 
 		++htab->filled;
+		hsort_invalidate(htab);
 
 		/* This is a new entry, so look up a possible callback */
 		env_callback_init(&htab->table[idx].entry);
@@ -397,8 +609,8 @@ int hsearch_r(struct env_entry item, enum env_action action,
 		env_flags_init(&htab->table[idx].entry);
 
 		/* check for permission */
-		if (htab->change_ok != NULL && htab->change_ok(
-		    &htab->table[idx].entry, item.data, env_op_create, flag)) {
+		if (call_change_ok(htab, &htab->table[idx].entry, item.data,
+				   env_op_create, flag)) {
 			debug("change_ok() rejected setting variable "
 				"%s, skipping it!\n", item.key);
 			_hdelete(item.key, htab, &htab->table[idx].entry, idx);
@@ -408,8 +620,8 @@ int hsearch_r(struct env_entry item, enum env_action action,
 		}
 
 		/* If there is a callback, call it */
-		if (do_callback(&htab->table[idx].entry, item.key, item.data,
-				env_op_create, flag)) {
+		if (do_callback(htab, &htab->table[idx].entry, item.key,
+				item.data, env_op_create, flag)) {
 			debug("callback() rejected setting variable "
 				"%s, skipping it!\n", item.key);
 			_hdelete(item.key, htab, &htab->table[idx].entry, idx);
@@ -444,12 +656,13 @@ static void _hdelete(const char *key, struct hsearch_data *htab,
 {
 	/* free used entry */
 	debug("hdelete: DELETING key \"%s\"\n", key);
-	free((void *)ep->key);
-	free(ep->data);
+	entry_free(&htab->table[idx]);
 	ep->flags = 0;
 	htab->table[idx].used = USED_DELETED;
 
 	--htab->filled;
+	++htab->deleted;
+	hsort_invalidate(htab);
 }
 
 int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
@@ -468,8 +681,7 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
 	}
 
 	/* Check for permission */
-	if (htab->change_ok != NULL &&
-	    htab->change_ok(ep, NULL, env_op_delete, flag)) {
+	if (call_change_ok(htab, ep, NULL, env_op_delete, flag)) {
 		debug("change_ok() rejected deleting variable "
 			"%s, skipping it!\n", key);
 		__set_errno(EPERM);
@@ -477,7 +689,7 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
 	}
 
 	/* If there is a callback, call it */
-	if (do_callback(&htab->table[idx].entry, key, NULL,
+	if (do_callback(htab, &htab->table[idx].entry, key, NULL,
 			env_op_delete, flag)) {
 		debug("callback() rejected deleting variable "
 			"%s, skipping it!\n", key);
@@ -603,7 +815,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		 char **resp, size_t size,
 		 int argc, char *const argv[])
 {
-	struct env_entry *list[htab->size];
+	struct env_entry **list = NULL, **order;
 	char *res, *p;
 	size_t totlen;
 	int i, n;
@@ -616,61 +828,91 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 
 	debug("EXPORT  table = %p, htab.size = %d, htab.filled = %d, size = %lu\n",
 	      htab, htab->size, htab->filled, (ulong)size);
-	/*
-	 * Pass 1:
-	 * search used entries,
-	 * save addresses and compute total length
-	 */
-	for (i = 1, n = 0, totlen = 0; i <= htab->size; ++i) {
 
-		if (htab->table[i].used > 0) {
-			struct env_entry *ep = &htab->table[i].entry;
-			int found = match_entry(ep, flag, argc, argv);
+	if (!argc && htab->sorted) {
+		/*
+		 * No keys were added or removed since the last full export,
+		 * so its order can be used again without sorting.
+		 */
+		order = htab->sorted;
+		n = htab->nsorted;
+	} else {
+		/* The table can be large, so keep this off the stack */
+		list = malloc((htab->filled + 1) * sizeof(struct env_entry *));
+		if (!list) {
+			__set_errno(ENOMEM);
+			return (-1);
+		}
+
+		/*
+		 * Pass 1:
+		 * search used entries and save addresses
+		 */
+		for (i = 1, n = 0; i <= htab->size; ++i) {
+			struct env_entry *ep;
 
-			if ((argc > 0) && (found == 0))
+			if (htab->table[i].used <= 0)
 				continue;
 
-			if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
+			ep = &htab->table[i].entry;
+			if (argc > 0 && !match_entry(ep, flag, argc, argv))
 				continue;
 
 			list[n++] = ep;
+		}
+
+#ifdef DEBUG
+		/* Pass 1a: print unsorted list */
+		printf("Unsorted: n=%d\n", n);
+		for (i = 0; i < n; ++i) {
+			printf("\t%3d: %p ==> %-10s => %s\n",
+			       i, list[i], list[i]->key, list[i]->data);
+		}
+#endif
+
+		/* Sort list by keys */
+		qsort(list, n, sizeof(struct env_entry *), cmpkey);
+		order = list;
+
+		/* Keep the order of a full export for next time */
+		if (!argc && n) {
+			htab->sorted = list;
+			htab->nsorted = n;
+			list = NULL;
+		}
+	}
+
+	/* Pass 1b: compute total length */
+	for (i = 0, totlen = 0; i < n; ++i) {
+		struct env_entry *ep = order[i];
+
+		if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
+			continue;
 
-			totlen += strlen(ep->key);
+		totlen += strlen(ep->key);
 
-			if (sep == '\0') {
-				totlen += strlen(ep->data);
-			} else {	/* check if escapes are needed */
-				char *s = ep->data;
+		if (sep == '\0') {
+			totlen += strlen(ep->data);
+		} else {	/* check if escapes are needed */
+			char *s = ep->data;
 
-				while (*s) {
+			while (*s) {
+				++totlen;
+				/* add room for needed escape chars */
+				if ((*s == sep) || (*s == '\\'))
 					++totlen;
-					/* add room for needed escape chars */
-					if ((*s == sep) || (*s == '\\'))
-						++totlen;
-					++s;
-				}
+				++s;
 			}
-			totlen += 2;	/* for '=' and 'sep' char */
 		}
+		totlen += 2;	/* for '=' and 'sep' char */
 	}
 
-#ifdef DEBUG
-	/* Pass 1a: print unsorted list */
-	printf("Unsorted: n=%d\n", n);
-	for (i = 0; i < n; ++i) {
-		printf("\t%3d: %p ==> %-10s => %s\n",
-		       i, list[i], list[i]->key, list[i]->data);
-	}
-#endif
-
-	/* Sort list by keys */
-	qsort(list, n, sizeof(struct env_entry *), cmpkey);
-
 	/* Check if the user supplied buffer size is sufficient */
 	if (size) {
 		if (size < totlen + 1) {	/* provided buffer too small */
 			printf("Env export buffer too small: %lu, but need %lu\n",
 			       (ulong)size, (ulong)totlen + 1);
+			free(list);
 			__set_errno(ENOMEM);
 			return (-1);
 		}
@@ -687,6 +929,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		/* no, allocate and clear one */
 		*resp = res = calloc(1, size);
 		if (res == NULL) {
+			free(list);
 			__set_errno(ENOMEM);
 			return (-1);
 		}
@@ -698,12 +941,15 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 	for (i = 0, p = res; i < n; ++i) {
 		const char *s;
 
-		s = list[i]->key;
+		if ((flag & H_HIDE_DOT) && order[i]->key[0] == '.')
+			continue;
+
+		s = order[i]->key;
 		while (*s)
 			*p++ = *s++;
 		*p++ = '=';
 
-		s = list[i]->data;
+		s = order[i]->data;
 
 		while (*s) {
 			if ((*s == sep) || (*s == '\\'))
@@ -713,6 +959,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		*p++ = sep;
 	}
 	*p = '\0';		/* terminate result */
+	free(list);
 
 	return size;
 }
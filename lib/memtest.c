@@ -0,0 +1,400 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Block-based memory test engine
+ *
+ * The tests here work on a cache line of words at a time. Plain (not
+ * volatile) pointers are used within each pass so that the compiler is
+ * free to use the widest stores and loads the CPU supports, with a compiler
+ * barrier between passes to make sure that every value is really written
+ * to and read back from memory. Reads are checked by OR-ing together the
+ * differences for a whole block, so the common (passing) case needs only
+ * one comparison per block.
+ */
+
+#define LOG_CATEGORY	LOGC_NONE
+
+#include <errno.h>
+#include <log.h>
+#include <memtest.h>
+#include <parallel.h>
+#include <time.h>
+#include <watchdog.h>
+#include <linux/compiler.h>
+#include <linux/kernel.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
+#include <linux/string.h>
+
+/* Number of words handled together, i.e. one 64-byte cache line on 64-bit */
+#define MT_BLOCK	8
+
+/* Number of bytes in each chunk of work handed to a CPU */
+#define MT_CHUNK_SIZE	SZ_256K
+
+#if CONFIG_IS_ENABLED(PARALLEL)
+#define MT_MAX_CPUS	CONFIG_PARALLEL_MAX_CPUS
+#else
+#define MT_MAX_CPUS	1
+#endif
+
+/**
+ * struct memtest_ctx - Context for a memory test
+ *
+ * @buf: Start of region being tested
+ * @start_addr: Address of @buf, for reporting and MEMTEST_OWN_ADDR
+ * @pattern: Pattern being used by the current pass
+ * @pass: Number of passes over the region completed so far
+ * @res: Result for each CPU, merged when the test completes
+ */
+struct memtest_ctx {
+	ulong *buf;
+	ulong start_addr;
+	ulong pattern;
+	int pass;
+	struct memtest_result res[MT_MAX_CPUS];
+};
+
+#if CONFIG_IS_ENABLED(UNIT_TEST)
+static memtest_hook_t mt_hook;
+
+void memtest_set_hook(memtest_hook_t hook)
+{
+	mt_hook = hook;
+}
+#else
+#define mt_hook	((memtest_hook_t)NULL)
+#endif
+
+static const char *const memtest_names[MEMTEST_COUNT] = {
+	[MEMTEST_ADDR_BITS]	= "address bits",
+	[MEMTEST_MOVING_INV]	= "moving inversions",
+	[MEMTEST_OWN_ADDR]	= "own address",
+};
+
+const char *memtest_name(enum memtest_t test)
+{
+	if (test < 0 || test >= MEMTEST_COUNT)
+		return "unknown";
+
+	return memtest_names[test];
+}
+
+static ulong mt_addr(struct memtest_ctx *ctx, const ulong *ptr)
+{
+	return ctx->start_addr + (ptr - ctx->buf) * sizeof(ulong);
+}
+
+static void mt_fail(struct memtest_ctx *ctx, int cpu, const ulong *ptr,
+		    ulong expected, ulong actual)
+{
+	struct memtest_result *res = &ctx->res[cpu];
+	ulong addr = mt_addr(ctx, ptr);
+
+	if (!res->errors || addr < res->fail_addr) {
+		res->fail_addr = addr;
+		res->expected = expected;
+		res->actual = actual;
+	}
+	res->errors++;
+}
+
+/* Keep the watchdog happy, but only from the boot CPU */
+static void mt_schedule(int cpu)
+{
+	if (!cpu)
+		schedule();
+}
+
+static void mt_fill(ulong *ptr, ulong count, ulong val)
+{
+	ulong *end = ptr + (count & ~(ulong)(MT_BLOCK - 1));
+
+	for (; ptr < end; ptr += MT_BLOCK) {
+		ptr[0] = val;
+		ptr[1] = val;
+		ptr[2] = val;
+		ptr[3] = val;
+		ptr[4] = val;
+		ptr[5] = val;
+		ptr[6] = val;
+		ptr[7] = val;
+	}
+	for (end += count & (MT_BLOCK - 1); ptr < end; ptr++)
+		*ptr = val;
+}
+
+/* Check that each word is @expected and then set it to @val */
+static void mt_check_set(struct memtest_ctx *ctx, int cpu, ulong *ptr,
+			 ulong count, ulong expected, ulong val)
+{
+	ulong *end = ptr + count;
+	ulong diff;
+	int i;
+
+	for (; ptr + MT_BLOCK <= end; ptr += MT_BLOCK) {
+		diff = (ptr[0] ^ expected) | (ptr[1] ^ expected) |
+			(ptr[2] ^ expected) | (ptr[3] ^ expected) |
+			(ptr[4] ^ expected) | (ptr[5] ^ expected) |
+			(ptr[6] ^ expected) | (ptr[7] ^ expected);
+		if (diff) {
+			for (i = 0; i < MT_BLOCK; i++) {
+				if (ptr[i] != expected)
+					mt_fail(ctx, cpu, &ptr[i], expected,
+						ptr[i]);
+			}
+		}
+		ptr[0] = val;
+		ptr[1] = val;
+		ptr[2] = val;
+		ptr[3] = val;
+		ptr[4] = val;
+		ptr[5] = val;
+		ptr[6] = val;
+		ptr[7] = val;
+	}
+	for (; ptr < end; ptr++) {
+		if (*ptr != expected)
+			mt_fail(ctx, cpu, ptr, expected, *ptr);
+		*ptr = val;
+	}
+}
+
+/* As mt_check_set() but working down from the top of the region */
+static void mt_check_set_down(struct memtest_ctx *ctx, int cpu, ulong *ptr,
+			      ulong count, ulong expected, ulong val)
+{
+	ulong *end = ptr + count;
+	ulong diff;
+	int i;
+
+	for (; end - ptr >= MT_BLOCK; end -= MT_BLOCK) {
+		ulong *blk = end - MT_BLOCK;
+
+		diff = (blk[7] ^ expected) | (blk[6] ^ expected) |
+			(blk[5] ^ expected) | (blk[4] ^ expected) |
+			(blk[3] ^ expected) | (blk[2] ^ expected) |
+			(blk[1] ^ expected) | (blk[0] ^ expected);
+		if (diff) {
+			for (i = MT_BLOCK - 1; i >= 0; i--) {
+				if (blk[i] != expected)
+					mt_fail(ctx, cpu, &blk[i], expected,
+						blk[i]);
+			}
+		}
+		blk[7] = val;
+		blk[6] = val;
+		blk[5] = val;
+		blk[4] = val;
+		blk[3] = val;
+		blk[2] = val;
+		blk[1] = val;
+		blk[0] = val;
+	}
+	while (end > ptr) {
+		end--;
+		if (*end != expected)
+			mt_fail(ctx, cpu, end, expected, *end);
+		*end = val;
+	}
+}
+
+static void mt_inv_fill(void *priv, ulong start, ulong end, int cpu)
+{
+	struct memtest_ctx *ctx = priv;
+
+	mt_fill(ctx->buf + start, end - start, ctx->pattern);
+	mt_schedule(cpu);
+}
+
+static void mt_inv_up(void *priv, ulong start, ulong end, int cpu)
+{
+	struct memtest_ctx *ctx = priv;
+
+	mt_check_set(ctx, cpu, ctx->buf + start, end - start, ctx->pattern,
+		     ~ctx->pattern);
+	mt_schedule(cpu);
+}
+
+static void mt_inv_down(void *priv, ulong start, ulong end, int cpu)
+{
+	struct memtest_ctx *ctx = priv;
+
+	mt_check_set_down(ctx, cpu, ctx->buf + start, end - start,
+			  ~ctx->pattern, ctx->pattern);
+	mt_schedule(cpu);
+}
+
+static void mt_own_fill(void *priv, ulong start, ulong end, int cpu)
+{
+	struct memtest_ctx *ctx = priv;
+	ulong *ptr = ctx->buf + start;
+	ulong *lim = ctx->buf + end;
+	ulong addr = mt_addr(ctx, ptr);
+
+	for (; ptr < lim; ptr++, addr += sizeof(ulong))
+		*ptr = addr ^ ctx->pattern;
+	mt_schedule(cpu);
+}
+
+static void mt_own_check(void *priv, ulong start, ulong end, int cpu)
+{
+	struct memtest_ctx *ctx = priv;
+	ulong *ptr = ctx->buf + start;
+	ulong *lim = ctx->buf + end;
+	ulong addr = mt_addr(ctx, ptr);
+	ulong diff;
+	int i;
+
+	for (; ptr + MT_BLOCK <= lim; ptr += MT_BLOCK) {
+		diff = 0;
+		for (i = 0; i < MT_BLOCK; i++)
+			diff |= ptr[i] ^ ctx->pattern ^
+				(addr + i * sizeof(ulong));
+		if (diff) {
+			for (i = 0; i < MT_BLOCK; i++) {
+				ulong expected = (addr + i * sizeof(ulong)) ^
+					ctx->pattern;
+
+				if (ptr[i] != expected)
+					mt_fail(ctx, cpu, &ptr[i], expected,
+						ptr[i]);
+			}
+		}
+		addr += MT_BLOCK * sizeof(ulong);
+	}
+	for (; ptr < lim; ptr++, addr += sizeof(ulong)) {
+		if (*ptr != (addr ^ ctx->pattern))
+			mt_fail(ctx, cpu, ptr, addr ^ ctx->pattern, *ptr);
+	}
+	mt_schedule(cpu);
+}
+
+/*
+ * Walking-ones test on the address lines. This only touches a few words so
+ * it runs on the boot CPU, using volatile accesses so that each write goes
+ * out on the bus in order.
+ */
+static ulong mt_addr_bits(struct memtest_ctx *ctx, ulong num_words)
+{
+	vu_long *addr = ctx->buf;
+	ulong pattern = ctx->pattern;
+	ulong anti_pattern = ~pattern;
+	ulong offset, test_offset, temp;
+	ulong accesses = 0;
+
+	for (offset = 1; offset < num_words; offset <<= 1)
+		addr[offset] = pattern;
+
+	/* Check for address bits stuck high */
+	addr[0] = anti_pattern;
+	for (offset = 1; offset < num_words; offset <<= 1) {
+		temp = addr[offset];
+		if (temp != pattern)
+			mt_fail(ctx, 0, (ulong *)&addr[offset], pattern, temp);
+		accesses++;
+	}
+	addr[0] = pattern;
+
+	/* Check for address bits stuck low or shorted */
+	for (test_offset = 1; test_offset < num_words; test_offset <<= 1) {
+		addr[test_offset] = anti_pattern;
+		temp = addr[0];
+		if (temp != pattern)
+			mt_fail(ctx, 0, (ulong *)&addr[0], pattern, temp);
+		for (offset = 1; offset < num_words; offset <<= 1) {
+			if (offset == test_offset)
+				continue;
+			temp = addr[offset];
+			if (temp != pattern)
+				mt_fail(ctx, 0, (ulong *)&addr[offset],
+					pattern, temp);
+			accesses++;
+		}
+		addr[test_offset] = pattern;
+		accesses += 3;
+	}
+
+	return accesses * sizeof(ulong);
+}
+
+static int mt_pass(struct memtest_ctx *ctx, ulong num_words, par_func_t func)
+{
+	int ret;
+
+	ret = parallel_for(num_words, MT_CHUNK_SIZE / sizeof(ulong), func, ctx);
+	/* Make sure the next pass really reads back what was written */
+	barrier();
+	if (mt_hook)
+		mt_hook(ctx->buf, ctx->pass);
+	ctx->pass++;
+
+	return ret;
+}
+
+int memtest_run(enum memtest_t test, void *buf, ulong start_addr, ulong size,
+		ulong pattern, struct memtest_result *res)
+{
+	struct memtest_ctx ctx;
+	ulong num_words = size / sizeof(ulong);
+	ulong start_us;
+	u64 bytes = 0;
+	int ret = 0;
+	int i;
+
+	memset(&ctx, '\0', sizeof(ctx));
+	ctx.buf = buf;
+	ctx.start_addr = start_addr;
+	ctx.pattern = pattern;
+
+	start_us = timer_get_us();
+	switch (test) {
+	case MEMTEST_ADDR_BITS:
+		bytes = mt_addr_bits(&ctx, num_words);
+		break;
+	case MEMTEST_MOVING_INV:
+		ret = mt_pass(&ctx, num_words, mt_inv_fill);
+		if (!ret)
+			ret = mt_pass(&ctx, num_words, mt_inv_up);
+		if (!ret)
+			ret = mt_pass(&ctx, num_words, mt_inv_down);
+		/* one write, then two passes which each read and write */
+		bytes = (u64)num_words * sizeof(ulong) * 5;
+		break;
+	case MEMTEST_OWN_ADDR:
+		ret = mt_pass(&ctx, num_words, mt_own_fill);
+		if (!ret)
+			ret = mt_pass(&ctx, num_words, mt_own_check);
+		bytes = (u64)num_words * sizeof(ulong) * 2;
+		break;
+	default:
+		return -EINVAL;
+	}
+	if (ret)
+		return log_msg_ret("mt", ret);
+
+	memset(res, '\0', sizeof(*res));
+	res->time_us = timer_get_us() - start_us;
+	res->bytes = bytes;
+	for (i = 0; i < MT_MAX_CPUS; i++) {
+		struct memtest_result *cpu_res = &ctx.res[i];
+
+		if (!cpu_res->errors)
+			continue;
+		if (!res->errors || cpu_res->fail_addr < res->fail_addr) {
+			res->fail_addr = cpu_res->fail_addr;
+			res->expected = cpu_res->expected;
+			res->actual = cpu_res->actual;
+		}
+		res->errors += cpu_res->errors;
+	}
+
+	return 0;
+}
+
+ulong memtest_bandwidth(const struct memtest_result *res)
+{
+	if (!res->time_us)
+		return 0;
+
+	return div_u64(res->bytes * 1000000, res->time_us) >> 20;
+}
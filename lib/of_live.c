@@ -17,10 +17,10 @@
 #include <malloc.h>
 #include <dm/of_access.h>
 #include <linux/err.h>
-#include <linux/sizes.h>
 
 enum {
-	BUF_STEP	= SZ_64K,
+	/* oldest version that can read the trees written by of_live_flatten() */
+	FDT_COMP_VERSION	= 0x10,
 };
 
 static void *unflatten_dt_alloc(void **mem, unsigned long size,
@@ -363,113 +363,166 @@ int of_live_create_empty(struct device_node **rootp)
 	return 0;
 }
 
-static int check_space(int ret, struct abuf *buf)
+/**
+ * struct flat_ctx - State used while writing out a flat tree
+ *
+ * @p: Next position to write in the structure block
+ * @strings: Strings block
+ * @str_size: Number of bytes used in @strings
+ * @slots: Hash table of offsets into @strings, plus one (0 means empty)
+ * @mask: Number of entries in @slots, minus one
+ */
+struct flat_ctx {
+	fdt32_t *p;
+	char *strings;
+	int str_size;
+	u32 *slots;
+	uint mask;
+};
+
+/**
+ * measure_node() - Work out the space needed to flatten a node
+ *
+ * @node: Node to check, along with its properties and subnodes
+ * @struct_sizep: Incremented by the size of the node in the structure block
+ * @nprops: Incremented by the number of properties
+ * @str_sizep: Incremented by the size of all property names
+ */
+static void measure_node(const struct device_node *node, int *struct_sizep,
+			 int *nprops, int *str_sizep)
 {
-	if (ret == -FDT_ERR_NOSPACE) {
-		if (!abuf_realloc_inc(buf, BUF_STEP))
-			return log_msg_ret("spc", -ENOMEM);
-		ret = fdt_resize(abuf_data(buf), abuf_data(buf),
-				 abuf_size(buf));
-		if (ret)
-			return log_msg_ret("res", -EFAULT);
-
-		return -EAGAIN;
+	const struct device_node *np;
+	const struct property *pp;
+
+	*struct_sizep += 2 * FDT_TAGSIZE +
+		ALIGN(strlen(node->name) + 1, FDT_TAGSIZE);
+	for (pp = node->properties; pp; pp = pp->next) {
+		*struct_sizep += sizeof(struct fdt_property) +
+			ALIGN(pp->length, FDT_TAGSIZE);
+		*str_sizep += strlen(pp->name) + 1;
+		(*nprops)++;
 	}
+	for (np = node->child; np; np = np->sibling)
+		measure_node(np, struct_sizep, nprops, str_sizep);
+}
 
-	return 0;
+/**
+ * add_string() - Find a property name in the strings block, adding it if new
+ *
+ * This uses a hash table since large trees may have thousands of different
+ * names, e.g. in /__symbols__
+ *
+ * @ctx: Flattening state
+ * @name: Name to add
+ * Return: offset of the name in the strings block
+ */
+static int add_string(struct flat_ctx *ctx, const char *name)
+{
+	int len = strlen(name);
+	uint hash = 0;
+	const char *s;
+	int offset;
+	uint i;
+
+	for (s = name; *s; s++)
+		hash = hash * 31 + *s;
+	for (i = hash & ctx->mask; ctx->slots[i]; i = (i + 1) & ctx->mask) {
+		offset = ctx->slots[i] - 1;
+		if (!strcmp(ctx->strings + offset, name))
+			return offset;
+	}
+
+	offset = ctx->str_size;
+	memcpy(ctx->strings + offset, name, len + 1);
+	ctx->str_size += len + 1;
+	ctx->slots[i] = offset + 1;
+
+	return offset;
 }
 
 /**
  * flatten_node() - Write out the node and its properties into a flat tree
  */
-static int flatten_node(struct abuf *buf, const struct device_node *node)
+static void flatten_node(struct flat_ctx *ctx, const struct device_node *node)
 {
 	const struct device_node *np;
 	const struct property *pp;
-	int ret;
+	int len;
 
-	ret = fdt_begin_node(abuf_data(buf), node->name);
-	ret = check_space(ret, buf);
-	if (ret == -EAGAIN) {
-		ret = fdt_begin_node(abuf_data(buf), node->name);
-		if (ret) {
-			log_debug("Internal error a %d\n", ret);
-			return -EFAULT;
-		}
-	}
-	if (ret)
-		return log_msg_ret("beg", ret);
+	*ctx->p++ = cpu_to_fdt32(FDT_BEGIN_NODE);
+	len = ALIGN(strlen(node->name) + 1, FDT_TAGSIZE);
+	memset((char *)ctx->p + len - FDT_TAGSIZE, '\0', FDT_TAGSIZE);
+	strcpy((char *)ctx->p, node->name);
+	ctx->p += len / FDT_TAGSIZE;
 
 	/* First write out the properties */
-	for (pp = node->properties; !ret && pp; pp = pp->next) {
-		ret = fdt_property(abuf_data(buf), pp->name, pp->value,
-				   pp->length);
-		ret = check_space(ret, buf);
-		if (ret == -EAGAIN) {
-			ret = fdt_property(abuf_data(buf), pp->name, pp->value,
-					   pp->length);
+	for (pp = node->properties; pp; pp = pp->next) {
+		struct fdt_property *prop = (struct fdt_property *)ctx->p;
+
+		prop->tag = cpu_to_fdt32(FDT_PROP);
+		prop->len = cpu_to_fdt32(pp->length);
+		prop->nameoff = cpu_to_fdt32(add_string(ctx, pp->name));
+		len = ALIGN(pp->length, FDT_TAGSIZE);
+		if (len) {
+			memset((char *)prop->data + len - FDT_TAGSIZE, '\0',
+			       FDT_TAGSIZE);
+			memcpy(prop->data, pp->value, pp->length);
 		}
+		ctx->p += (sizeof(*prop) + len) / FDT_TAGSIZE;
 	}
 
 	/* Next write out the subnodes */
-	for (np = node->child; np; np = np->sibling) {
-		ret = flatten_node(buf, np);
-		if (ret)
-			return log_msg_ret("sub", ret);
-	}
+	for (np = node->child; np; np = np->sibling)
+		flatten_node(ctx, np);
 
-	ret = fdt_end_node(abuf_data(buf));
-	ret = check_space(ret, buf);
-	if (ret == -EAGAIN) {
-		ret = fdt_end_node(abuf_data(buf));
-		if (ret) {
-			log_debug("Internal error b %d\n", ret);
-			return -EFAULT;
-		}
-	}
-	if (ret)
-		return log_msg_ret("end", ret);
-
-	return 0;
+	*ctx->p++ = cpu_to_fdt32(FDT_END_NODE);
 }
 
 int of_live_flatten(const struct device_node *root, struct abuf *buf)
 {
-	int ret;
+	int struct_size = FDT_TAGSIZE, nprops = 0, str_max = 0;
+	struct fdt_header *fdt;
+	struct flat_ctx ctx;
+	int off_struct;
+	uint nslots;
 
 	abuf_init(buf);
-	if (!abuf_realloc(buf, BUF_STEP))
-		return log_msg_ret("ini", -ENOMEM);
-
-	ret = fdt_create(abuf_data(buf), abuf_size(buf));
-	if (!ret)
-		ret = fdt_finish_reservemap(abuf_data(buf));
-	if (ret) {
-		log_debug("Failed to start FDT (err=%d)\n", ret);
-		return log_msg_ret("sta", -EINVAL);
-	}
+	measure_node(root, &struct_size, &nprops, &str_max);
 
-	ret = flatten_node(buf, root);
-	if (ret)
-		return log_msg_ret("flt", ret);
-
-	ret = fdt_finish(abuf_data(buf));
-	ret = check_space(ret, buf);
-	if (ret == -EAGAIN) {
-		ret = fdt_finish(abuf_data(buf));
-		if (ret) {
-			log_debug("Internal error c %d\n", ret);
-			return -EFAULT;
-		}
-	}
-	if (ret)
-		return log_msg_ret("fin", ret);
-
-	ret = fdt_pack(abuf_data(buf));
-	if (ret) {
-		log_debug("Failed to pack (err=%d)\n", ret);
-		return log_msg_ret("pac", -EFAULT);
+	/* the same layout as fdt_create() followed by fdt_pack() */
+	off_struct = ALIGN(sizeof(*fdt), sizeof(struct fdt_reserve_entry)) +
+		sizeof(struct fdt_reserve_entry);
+	if (!abuf_realloc(buf, off_struct + struct_size + str_max))
+		return log_msg_ret("ini", -ENOMEM);
+	fdt = abuf_data(buf);
+	memset(fdt, '\0', off_struct);
+
+	for (nslots = 16; nslots < nprops * 2; nslots *= 2)
+		;
+	ctx.slots = calloc(nslots, sizeof(u32));
+	if (!ctx.slots) {
+		abuf_uninit(buf);
+		return log_msg_ret("has", -ENOMEM);
 	}
+	ctx.mask = nslots - 1;
+	ctx.p = (void *)fdt + off_struct;
+	ctx.strings = (void *)fdt + off_struct + struct_size;
+	ctx.str_size = 0;
+
+	flatten_node(&ctx, root);
+	*ctx.p++ = cpu_to_fdt32(FDT_END);
+	free(ctx.slots);
+
+	fdt_set_magic(fdt, FDT_MAGIC);
+	fdt_set_version(fdt, FDT_LAST_SUPPORTED_VERSION);
+	fdt_set_last_comp_version(fdt, FDT_COMP_VERSION);
+	fdt_set_off_mem_rsvmap(fdt, off_struct -
+			       sizeof(struct fdt_reserve_entry));
+	fdt_set_off_dt_struct(fdt, off_struct);
+	fdt_set_size_dt_struct(fdt, struct_size);
+	fdt_set_off_dt_strings(fdt, off_struct + struct_size);
+	fdt_set_size_dt_strings(fdt, ctx.str_size);
+	fdt_set_totalsize(fdt, off_struct + struct_size + ctx.str_size);
 
 	if (!abuf_realloc(buf, fdt_totalsize(abuf_data(buf))))
 		return log_msg_ret("abu", -EFAULT);
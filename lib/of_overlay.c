@@ -0,0 +1,860 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Apply device tree overlays using a live (hierarchical) tree
+ *
+ * This follows the same rules as fdt_overlay_apply() in libfdt, but merges
+ * the overlays into an unflattened copy of the base tree, so that adding a
+ * property or node does not need to move the rest of the flat tree. The
+ * tree is flattened again once all overlays are applied.
+ *
+ * Overlays are small, so the phandle fixups are done on a private flat copy
+ * of each overlay, which the merged tree then points into.
+ */
+
+#define LOG_CATEGORY	LOGC_DT
+
+#include <abuf.h>
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <of_live.h>
+#include <of_overlay.h>
+#include <asm/unaligned.h>
+#include <dm/of.h>
+#include <linux/libfdt.h>
+#include <linux/string.h>
+
+enum {
+	/* Minimum number of entries in each hash table */
+	HASH_MIN_SIZE	= 64,
+};
+
+/**
+ * struct of_overlay_mem - Allocation owned by an overlay context
+ *
+ * New nodes and properties cannot be freed individually, since most of the
+ * tree is a single block from unflatten_device_tree(). Instead, everything
+ * allocated while applying overlays is chained here and freed at the end.
+ *
+ * @next: Next allocation in the list, or NULL if none
+ * @data: Allocated memory
+ */
+struct of_overlay_mem {
+	struct of_overlay_mem *next;
+	ulong data[];
+};
+
+static void *ovl_alloc(struct of_overlay_ctx *ctx, int size)
+{
+	struct of_overlay_mem *mem;
+
+	mem = malloc(sizeof(*mem) + size);
+	if (!mem)
+		return NULL;
+	mem->next = ctx->mem;
+	ctx->mem = mem;
+
+	return mem->data;
+}
+
+static struct device_node *next_node(struct device_node *np)
+{
+	if (np->child)
+		return np->child;
+	while (!np->sibling && np->parent)
+		np = np->parent;
+
+	return np->sibling;
+}
+
+/**
+ * struct of_overlay_slot - Entry in a hash table
+ *
+ * @hash: Hash of the item's key
+ * @item: Node or property, or NULL if this slot is empty
+ */
+struct of_overlay_slot {
+	uint hash;
+	void *item;
+};
+
+static uint hash_str(const char *str, int len)
+{
+	uint hash = 2166136261U;
+
+	while (len--)
+		hash = (hash ^ (u8)*str++) * 16777619U;
+
+	return hash;
+}
+
+static uint hash_phandle(u32 phandle)
+{
+	return phandle * 0x9e3779b1U;
+}
+
+static void hash_put(struct of_overlay_slot *slots, uint size, uint hash,
+		     void *item)
+{
+	uint i;
+
+	for (i = hash & (size - 1); slots[i].item; i = (i + 1) & (size - 1))
+		;
+	slots[i].hash = hash;
+	slots[i].item = item;
+}
+
+static int hash_add(struct of_overlay_hash *tab, uint hash, void *item)
+{
+	if ((tab->count + 1) * 2 > tab->size) {
+		uint size = max(tab->size * 2, (uint)HASH_MIN_SIZE);
+		struct of_overlay_slot *slots;
+		uint i;
+
+		slots = calloc(size, sizeof(*slots));
+		if (!slots)
+			return -ENOMEM;
+		for (i = 0; i < tab->size; i++) {
+			if (tab->slots[i].item)
+				hash_put(slots, size, tab->slots[i].hash,
+					 tab->slots[i].item);
+		}
+		free(tab->slots);
+		tab->slots = slots;
+		tab->size = size;
+	}
+	hash_put(tab->slots, tab->size, hash, item);
+	tab->count++;
+
+	return 0;
+}
+
+/**
+ * hash_next() - Find the next item in a table with the given hash
+ *
+ * @tab: Table to search
+ * @hash: Hash to look for
+ * @posp: Position to start at, set to -1 for the first call. This is updated
+ *	to the position of the item found
+ * Return: next item with a matching hash, or NULL if none
+ */
+static void *hash_next(const struct of_overlay_hash *tab, uint hash,
+		       uint *posp)
+{
+	uint mask = tab->size - 1;
+	uint i;
+
+	if (!tab->size)
+		return NULL;
+	i = *posp == -1U ? hash & mask : (*posp + 1) & mask;
+	for (; tab->slots[i].item; i = (i + 1) & mask) {
+		if (tab->slots[i].hash == hash) {
+			*posp = i;
+			return tab->slots[i].item;
+		}
+	}
+
+	return NULL;
+}
+
+static void hash_uninit(struct of_overlay_hash *tab)
+{
+	free(tab->slots);
+}
+
+static int add_phandle(struct of_overlay_ctx *ctx, struct device_node *np)
+{
+	ctx->max_phandle = max(ctx->max_phandle, np->phandle);
+
+	return hash_add(&ctx->phandles, hash_phandle(np->phandle), np);
+}
+
+static struct device_node *find_by_phandle(struct of_overlay_ctx *ctx,
+					   u32 phandle)
+{
+	uint hash = hash_phandle(phandle), pos = -1U;
+	struct device_node *np;
+
+	/* a node may have had its phandle changed, so check every match */
+	while ((np = hash_next(&ctx->phandles, hash, &pos))) {
+		if (np->phandle == phandle)
+			return np;
+	}
+
+	return NULL;
+}
+
+static int add_path(struct of_overlay_ctx *ctx, struct device_node *np)
+{
+	return hash_add(&ctx->paths,
+			hash_str(np->full_name, strlen(np->full_name)), np);
+}
+
+static struct device_node *find_by_full_path(struct of_overlay_ctx *ctx,
+					     const char *path, int len)
+{
+	uint hash = hash_str(path, len), pos = -1U;
+	struct device_node *np;
+
+	while ((np = hash_next(&ctx->paths, hash, &pos))) {
+		if (!strncmp(np->full_name, path, len) && !np->full_name[len])
+			return np;
+	}
+
+	return NULL;
+}
+
+static int add_label(struct of_overlay_ctx *ctx, struct property *pp)
+{
+	return hash_add(&ctx->labels, hash_str(pp->name, strlen(pp->name)),
+			pp);
+}
+
+static struct property *find_label(struct of_overlay_ctx *ctx,
+				   const char *name)
+{
+	uint hash = hash_str(name, strlen(name)), pos = -1U;
+	struct property *pp;
+
+	while ((pp = hash_next(&ctx->labels, hash, &pos))) {
+		if (!strcmp(pp->name, name))
+			return pp;
+	}
+
+	return NULL;
+}
+
+/* The symbols table is only needed by overlays with external references */
+static int build_labels(struct of_overlay_ctx *ctx)
+{
+	struct property *pp;
+	int ret;
+
+	if (ctx->labels.size || !ctx->symbols)
+		return 0;
+	for (pp = ctx->symbols->properties; pp; pp = pp->next) {
+		ret = add_label(ctx, pp);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Match node names the same way as libfdt, i.e. "abc" matches "abc@1" */
+static bool node_name_eq(const char *name, const char *s, int len)
+{
+	if (strncmp(name, s, len))
+		return false;
+	if (!name[len])
+		return true;
+
+	return name[len] == '@' && !memchr(s, '@', len);
+}
+
+static struct device_node *find_child(struct device_node *parent,
+				      const char *name, int len)
+{
+	struct device_node *np;
+
+	for (np = parent->child; np; np = np->sibling) {
+		if (node_name_eq(np->name, name, len))
+			return np;
+	}
+
+	return NULL;
+}
+
+static struct property *find_prop(struct device_node *np, const char *name,
+				  int len)
+{
+	struct property *pp;
+
+	for (pp = np->properties; pp; pp = pp->next) {
+		if (!strncmp(pp->name, name, len) && !pp->name[len])
+			return pp;
+	}
+
+	return NULL;
+}
+
+static struct device_node *find_node_by_path(struct of_overlay_ctx *ctx,
+					     const char *path, int len)
+{
+	const char *end = path + len, *p = path, *q;
+	struct device_node *np = ctx->root;
+
+	/* the path could begin with an alias */
+	if (*path != '/') {
+		struct device_node *aliases;
+		struct property *pp;
+
+		q = memchr(p, '/', end - p);
+		if (!q)
+			q = end;
+		aliases = find_child(ctx->root, "aliases", 7);
+		pp = aliases ? find_prop(aliases, p, q - p) : NULL;
+		if (!pp || pp->length < 1 || *(char *)pp->value != '/')
+			return NULL;
+		np = find_node_by_path(ctx, pp->value,
+				       strnlen(pp->value, pp->length));
+		p = q;
+	}
+
+	/* most paths come from /__symbols__ and are complete */
+	if (np == ctx->root && end - p > 1) {
+		struct device_node *found;
+
+		found = find_by_full_path(ctx, p, end - p);
+		if (found)
+			return found;
+	}
+
+	while (np && p < end) {
+		if (*p == '/') {
+			p++;
+			continue;
+		}
+		q = memchr(p, '/', end - p);
+		if (!q)
+			q = end;
+		np = find_child(np, p, q - p);
+		p = q;
+	}
+
+	return np;
+}
+
+static struct device_node *add_child(struct of_overlay_ctx *ctx,
+				     struct device_node *parent,
+				     const char *name)
+{
+	struct device_node *np, *last;
+	int parent_len, len;
+	char *full_name;
+
+	/* the root node has a full name of "/", but children don't need it */
+	parent_len = parent->parent ? strlen(parent->full_name) : 0;
+	len = strlen(name);
+	np = ovl_alloc(ctx, sizeof(*np) + parent_len + 1 + len + 1);
+	if (!np)
+		return NULL;
+	memset(np, '\0', sizeof(*np));
+	full_name = (char *)(np + 1);
+	memcpy(full_name, parent->full_name, parent_len);
+	full_name[parent_len] = '/';
+	strcpy(full_name + parent_len + 1, name);
+
+	np->name = name;
+	np->type = "<NULL>";
+	np->full_name = full_name;
+	np->parent = parent;
+
+	if (add_path(ctx, np))
+		return NULL;
+
+	/* add as the last child, to keep the order of the overlay */
+	if (parent->child) {
+		for (last = parent->child; last->sibling; last = last->sibling)
+			;
+		last->sibling = np;
+	} else {
+		parent->child = np;
+	}
+
+	return np;
+}
+
+static struct property *set_prop(struct of_overlay_ctx *ctx,
+				 struct device_node *np, const char *name,
+				 const void *value, int len)
+{
+	struct property *pp, **prevp;
+	int ret;
+
+	for (prevp = &np->properties; (pp = *prevp); prevp = &pp->next) {
+		if (!strcmp(pp->name, name))
+			break;
+	}
+	if (!pp) {
+		pp = ovl_alloc(ctx, sizeof(*pp));
+		if (!pp)
+			return NULL;
+		pp->name = (char *)name;
+		pp->next = NULL;
+		*prevp = pp;
+	}
+	pp->value = (void *)value;
+	pp->length = len;
+
+	if (len == sizeof(u32) && (!strcmp(name, "phandle") ||
+				   !strcmp(name, "linux,phandle"))) {
+		np->phandle = get_unaligned_be32(value);
+		ret = add_phandle(ctx, np);
+		if (ret)
+			return NULL;
+	} else if (!strcmp(name, "device_type")) {
+		np->type = value;
+	}
+
+	return pp;
+}
+
+/**
+ * adjust_phandles() - Move the overlay's phandles above those in the tree
+ *
+ * @fdto: Overlay to update
+ * @delta: Value to add to each phandle
+ * Return: 0 if OK, -EINVAL if a phandle is invalid, -ERANGE on overflow
+ */
+static int adjust_phandles(void *fdto, u32 delta)
+{
+	static const char *const names[] = { "phandle", "linux,phandle" };
+	int node, i, len;
+
+	for (node = 0; node >= 0; node = fdt_next_node(fdto, node, NULL)) {
+		for (i = 0; i < ARRAY_SIZE(names); i++) {
+			void *val;
+			u32 ph;
+
+			val = fdt_getprop_w(fdto, node, names[i], &len);
+			if (!val)
+				continue;
+			if (len != sizeof(u32))
+				return log_msg_ret("len", -EINVAL);
+			ph = get_unaligned_be32(val);
+			if (ph + delta < ph || ph + delta == (u32)-1)
+				return log_msg_ret("ovf", -ERANGE);
+			put_unaligned_be32(ph + delta, val);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * update_local_refs() - Update references to the overlay's own phandles
+ *
+ * @fdto: Overlay to update
+ * @node: Node in the overlay to update
+ * @fixup: Matching node in /__local_fixups__
+ * @delta: Value to add to each reference
+ * Return: 0 if OK, -EINVAL if the fixups do not match the overlay
+ */
+static int update_local_refs(void *fdto, int node, int fixup, u32 delta)
+{
+	int prop, sub, ret;
+
+	fdt_for_each_property_offset(prop, fdto, fixup) {
+		const fdt32_t *offsets;
+		const char *name;
+		int len, tree_len, i;
+		char *val;
+
+		offsets = fdt_getprop_by_offset(fdto, prop, &name, &len);
+		if (!offsets || len % sizeof(u32))
+			return log_msg_ret("fix", -EINVAL);
+		val = fdt_getprop_w(fdto, node, name, &tree_len);
+		if (!val)
+			return log_msg_ret("prp", -EINVAL);
+
+		for (i = 0; i < len / sizeof(u32); i++) {
+			uint pos = fdt32_to_cpu(offsets[i]);
+
+			if (pos + sizeof(u32) > tree_len)
+				return log_msg_ret("pos", -EINVAL);
+			put_unaligned_be32(get_unaligned_be32(val + pos) +
+					   delta, val + pos);
+		}
+	}
+
+	fdt_for_each_subnode(sub, fdto, fixup) {
+		const char *name = fdt_get_name(fdto, sub, NULL);
+		int tree_sub;
+
+		tree_sub = fdt_subnode_offset(fdto, node, name);
+		if (tree_sub < 0)
+			return log_msg_ret("sub", -EINVAL);
+		ret = update_local_refs(fdto, tree_sub, sub, delta);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * fixup_phandles() - Fill in the overlay's references to the base tree
+ *
+ * Each property in /__fixups__ is named after a label in the tree and lists
+ * the places in the overlay which refer to it, as "path:property:offset"
+ *
+ * @ctx: Overlay context
+ * @fdto: Overlay to update
+ * Return: 0 if OK, -ENOENT if a label or its node is missing, -EINVAL if the
+ *	fixups do not match the overlay
+ */
+static int fixup_phandles(struct of_overlay_ctx *ctx, void *fdto)
+{
+	int fixups, prop, ret;
+
+	fixups = fdt_path_offset(fdto, "/__fixups__");
+	if (fixups < 0)
+		return 0;
+
+	ret = build_labels(ctx);
+	if (ret)
+		return log_msg_ret("lbl", ret);
+
+	fdt_for_each_property_offset(prop, fdto, fixups) {
+		const char *label, *val, *end;
+		struct device_node *target;
+		struct property *sym;
+		int len;
+
+		val = fdt_getprop_by_offset(fdto, prop, &label, &len);
+		if (!val)
+			return log_msg_ret("fix", -EINVAL);
+		sym = find_label(ctx, label);
+		if (!sym) {
+			log_debug("Symbol '%s' not found\n", label);
+			return log_msg_ret("sym", -ENOENT);
+		}
+		target = find_node_by_path(ctx, sym->value,
+					   strnlen(sym->value, sym->length));
+		if (!target || !target->phandle) {
+			log_debug("Node for symbol '%s' not found\n", label);
+			return log_msg_ret("tgt", -ENOENT);
+		}
+
+		for (end = val + len; val < end; val += strlen(val) + 1) {
+			const char *name, *sep;
+			int node, plen;
+			char *endp;
+			ulong pos;
+			void *p;
+
+			if (!memchr(val, '\0', end - val))
+				return log_msg_ret("str", -EINVAL);
+			name = strchr(val, ':');
+			sep = name ? strchr(++name, ':') : NULL;
+			if (!sep || sep == name)
+				return log_msg_ret("fmt", -EINVAL);
+			pos = simple_strtoul(sep + 1, &endp, 10);
+			if (*endp || endp == sep + 1)
+				return log_msg_ret("off", -EINVAL);
+
+			node = fdt_path_offset_namelen(fdto, val,
+						       name - 1 - val);
+			if (node < 0)
+				return log_msg_ret("pth", -EINVAL);
+			p = fdt_getprop_namelen_w(fdto, node, name, sep - name,
+						  &plen);
+			if (!p || pos + sizeof(u32) > plen)
+				return log_msg_ret("prp", -EINVAL);
+			put_unaligned_be32(target->phandle, p + pos);
+		}
+	}
+
+	return 0;
+}
+
+static struct device_node *get_target(struct of_overlay_ctx *ctx,
+				      const void *fdto, int fragment,
+				      const char **pathp)
+{
+	const char *path;
+	const void *val;
+	int len;
+
+	*pathp = NULL;
+	val = fdt_getprop(fdto, fragment, "target", &len);
+	if (val) {
+		if (len != sizeof(u32))
+			return NULL;
+
+		return find_by_phandle(ctx, get_unaligned_be32(val));
+	}
+
+	path = fdt_getprop(fdto, fragment, "target-path", &len);
+	if (!path || len < 1)
+		return NULL;
+	*pathp = path;
+
+	return find_node_by_path(ctx, path, strnlen(path, len));
+}
+
+static int apply_node(struct of_overlay_ctx *ctx, struct device_node *np,
+		      const void *fdto, int node)
+{
+	int prop, sub, ret;
+
+	fdt_for_each_property_offset(prop, fdto, node) {
+		const char *name;
+		const void *val;
+		int len;
+
+		val = fdt_getprop_by_offset(fdto, prop, &name, &len);
+		if (!val)
+			return log_msg_ret("prp", -EINVAL);
+		if (!set_prop(ctx, np, name, val, len))
+			return log_msg_ret("set", -ENOMEM);
+	}
+
+	fdt_for_each_subnode(sub, fdto, node) {
+		const char *name = fdt_get_name(fdto, sub, NULL);
+		struct device_node *child;
+
+		child = find_child(np, name, strlen(name));
+		if (!child) {
+			child = add_child(ctx, np, name);
+			if (!child)
+				return log_msg_ret("add", -ENOMEM);
+		}
+		ret = apply_node(ctx, child, fdto, sub);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int merge(struct of_overlay_ctx *ctx, const void *fdto)
+{
+	int fragment, ret;
+
+	fdt_for_each_subnode(fragment, fdto, 0) {
+		struct device_node *target;
+		const char *path;
+		int overlay;
+
+		/* fragments without an __overlay__ node are not merged */
+		overlay = fdt_subnode_offset(fdto, fragment, "__overlay__");
+		if (overlay < 0)
+			continue;
+
+		target = get_target(ctx, fdto, fragment, &path);
+		if (!target) {
+			log_debug("Target of '%s' not found\n",
+				  fdt_get_name(fdto, fragment, NULL));
+			return log_msg_ret("tgt", -ENOENT);
+		}
+		ret = apply_node(ctx, target, fdto, overlay);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * update_symbols() - Add the overlay's symbols to /__symbols__
+ *
+ * Symbols in the overlay have paths like /fragment@0/__overlay__/node, which
+ * are converted to the path of the node in the merged tree
+ *
+ * @ctx: Overlay context
+ * @fdto: Overlay being applied
+ * Return: 0 if OK, -EINVAL if a symbol is not valid, -ENOMEM if out of memory
+ */
+static int update_symbols(struct of_overlay_ctx *ctx, const void *fdto)
+{
+	static const char ovname[] = "/__overlay__";
+	int ov_sym, prop, ret;
+
+	ov_sym = fdt_subnode_offset(fdto, 0, "__symbols__");
+	if (ov_sym < 0)
+		return 0;
+
+	if (!ctx->symbols) {
+		ctx->symbols = add_child(ctx, ctx->root, "__symbols__");
+		if (!ctx->symbols)
+			return log_msg_ret("sym", -ENOMEM);
+	}
+
+	fdt_for_each_property_offset(prop, fdto, ov_sym) {
+		const char *path, *name, *s, *rel, *tpath;
+		struct device_node *target;
+		int len, fragment, tlen;
+		struct property *pp;
+		char *buf;
+
+		path = fdt_getprop_by_offset(fdto, prop, &name, &len);
+		if (!path || len < 1 || *path != '/' ||
+		    memchr(path, '\0', len) != path + len - 1)
+			return log_msg_ret("val", -EINVAL);
+
+		/* skip symbols which do not end up in the tree */
+		s = strchr(path + 1, '/');
+		if (!s || strncmp(s, ovname, sizeof(ovname) - 1))
+			continue;
+		rel = s + sizeof(ovname) - 1;
+		if (*rel == '/')
+			rel++;
+		else if (*rel)
+			continue;
+
+		fragment = fdt_subnode_offset_namelen(fdto, 0, path + 1,
+						      s - path - 1);
+		if (fragment < 0 ||
+		    fdt_subnode_offset(fdto, fragment, "__overlay__") < 0)
+			return log_msg_ret("frg", -EINVAL);
+		target = get_target(ctx, fdto, fragment, &tpath);
+		if (!target)
+			return log_msg_ret("tgt", -ENOENT);
+		if (!tpath)
+			tpath = target->full_name;
+
+		/* this matches libfdt, which adds a '/' even if rel is empty */
+		tlen = strlen(tpath);
+		if (tlen == 1)
+			tlen = 0;
+		buf = ovl_alloc(ctx, tlen + 1 + strlen(rel) + 1);
+		if (!buf)
+			return log_msg_ret("buf", -ENOMEM);
+		memcpy(buf, tpath, tlen);
+		buf[tlen] = '/';
+		strcpy(buf + tlen + 1, rel);
+
+		pp = set_prop(ctx, ctx->symbols, name, buf, strlen(buf) + 1);
+		if (!pp)
+			return log_msg_ret("set", -ENOMEM);
+		if (ctx->labels.size && !find_label(ctx, name)) {
+			ret = add_label(ctx, pp);
+			if (ret)
+				return log_msg_ret("ins", ret);
+		}
+	}
+
+	return 0;
+}
+
+int of_overlay_start(struct of_overlay_ctx *ctx, void *fdt)
+{
+	struct device_node *np;
+	int ret;
+
+	memset(ctx, '\0', sizeof(*ctx));
+	ret = unflatten_device_tree(fdt, &ctx->root);
+	if (ret) {
+		ctx->root = NULL;
+		return log_msg_ret("unf", ret);
+	}
+	ctx->fdt = fdt;
+
+	for (np = ctx->root; np; np = next_node(np)) {
+		ret = add_path(ctx, np);
+		if (!ret && np->phandle)
+			ret = add_phandle(ctx, np);
+		if (ret)
+			return log_msg_ret("add", ret);
+	}
+	ctx->symbols = find_child(ctx->root, "__symbols__", 11);
+
+	return 0;
+}
+
+int of_overlay_add(struct of_overlay_ctx *ctx, const void *fdto)
+{
+	void *copy;
+	int fixups;
+	int ret;
+
+	if (fdt_check_header(fdto))
+		return log_msg_ret("hdr", -EINVAL);
+
+	/* the tree keeps pointers into this copy, so it lives until the end */
+	copy = ovl_alloc(ctx, fdt_totalsize(fdto));
+	if (!copy)
+		return log_msg_ret("cpy", -ENOMEM);
+	memcpy(copy, fdto, fdt_totalsize(fdto));
+
+	ret = adjust_phandles(copy, ctx->max_phandle);
+	if (ret)
+		return log_msg_ret("adj", ret);
+
+	fixups = fdt_path_offset(copy, "/__local_fixups__");
+	if (fixups >= 0) {
+		ret = update_local_refs(copy, 0, fixups, ctx->max_phandle);
+		if (ret)
+			return log_msg_ret("loc", ret);
+	}
+
+	ret = fixup_phandles(ctx, copy);
+	if (ret)
+		return log_msg_ret("fix", ret);
+
+	ret = merge(ctx, copy);
+	if (ret)
+		return log_msg_ret("mrg", ret);
+
+	ret = update_symbols(ctx, copy);
+	if (ret)
+		return log_msg_ret("sym", ret);
+
+	return 0;
+}
+
+int of_overlay_finish(struct of_overlay_ctx *ctx, void *fdt, int size)
+{
+	u64 *rsv = NULL;
+	struct abuf buf;
+	int nrsv, cpuid;
+	int ret, i;
+
+	/* read these before @fdt is overwritten, since it may be the base */
+	cpuid = fdt_boot_cpuid_phys(ctx->fdt);
+	nrsv = fdt_num_mem_rsv(ctx->fdt);
+	if (nrsv > 0) {
+		rsv = malloc(nrsv * 2 * sizeof(u64));
+		if (!rsv)
+			return log_msg_ret("rsv", -ENOMEM);
+		for (i = 0; i < nrsv; i++)
+			fdt_get_mem_rsv(ctx->fdt, i, &rsv[i * 2], &rsv[i * 2 + 1]);
+	}
+
+	ret = of_live_flatten(ctx->root, &buf);
+	if (ret) {
+		ret = log_msg_ret("flt", ret);
+		goto out;
+	}
+	if (abuf_size(&buf) + max(nrsv, 0) * sizeof(struct fdt_reserve_entry) >
+	    size) {
+		ret = log_msg_ret("spc", -ENOSPC);
+		goto out;
+	}
+
+	ret = fdt_open_into(abuf_data(&buf), fdt, size);
+	for (i = 0; !ret && i < nrsv; i++)
+		ret = fdt_add_mem_rsv(fdt, rsv[i * 2], rsv[i * 2 + 1]);
+	if (!ret) {
+		fdt_set_boot_cpuid_phys(fdt, cpuid);
+		ret = fdt_pack(fdt);
+	}
+	if (ret) {
+		log_debug("Failed to write tree (err=%d)\n", ret);
+		ret = log_msg_ret("wr", -ENOSPC);
+	}
+
+out:
+	abuf_uninit(&buf);
+	free(rsv);
+
+	return ret;
+}
+
+void of_overlay_uninit(struct of_overlay_ctx *ctx)
+{
+	struct of_overlay_mem *mem, *next;
+
+	for (mem = ctx->mem; mem; mem = next) {
+		next = mem->next;
+		free(mem);
+	}
+	hash_uninit(&ctx->phandles);
+	hash_uninit(&ctx->paths);
+	hash_uninit(&ctx->labels);
+	if (ctx->root)
+		of_live_free(ctx->root);
+	memset(ctx, '\0', sizeof(*ctx));
+}
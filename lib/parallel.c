@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Simple work sharing across the CPUs available to U-Boot
+ */
+
+#define LOG_CATEGORY	LOGC_NONE
+
+#include <errno.h>
+#include <log.h>
+#include <parallel.h>
+#include <linux/kernel.h>
+
+/**
+ * struct par_ctx - Information about a parallel_for() operation
+ *
+ * @func: Function to call for each chunk
+ * @priv: Private data for @func
+ * @count: Total number of items
+ * @grain: Number of items in each chunk
+ * @next: Next item to be claimed, updated atomically by each CPU
+ */
+struct par_ctx {
+	par_func_t func;
+	void *priv;
+	ulong count;
+	ulong grain;
+	ulong next;
+};
+
+__weak int arch_parallel_num_cpus(void)
+{
+	return 1;
+}
+
+__weak int arch_parallel_run(int nr_cpus, void (*func)(void *ctx, int cpu),
+			     void *ctx)
+{
+	return -ENOSYS;
+}
+
+int parallel_num_cpus(void)
+{
+	return clamp(arch_parallel_num_cpus(), 1, CONFIG_PARALLEL_MAX_CPUS);
+}
+
+static void par_worker(void *ptr, int cpu)
+{
+	struct par_ctx *ctx = ptr;
+	ulong start, len;
+
+	while (1) {
+		start = __atomic_fetch_add(&ctx->next, ctx->grain,
+					   __ATOMIC_RELAXED);
+		if (start >= ctx->count)
+			break;
+		len = min(ctx->grain, ctx->count - start);
+		ctx->func(ctx->priv, start, start + len, cpu);
+
+		/* stop after the last chunk, in case the counter wraps */
+		if (start + len == ctx->count)
+			break;
+	}
+}
+
+int parallel_for(ulong count, ulong grain, par_func_t func, void *priv)
+{
+	struct par_ctx ctx;
+	int cpus, ret;
+
+	if (!grain)
+		return -EINVAL;
+	if (!count)
+		return 0;
+
+	ctx.func = func;
+	ctx.priv = priv;
+	ctx.count = count;
+	ctx.grain = grain;
+	ctx.next = 0;
+
+	/*
+	 * Stop the counter wrapping if many CPUs overshoot the end, i.e. check
+	 * count + grain * CONFIG_PARALLEL_MAX_CPUS without overflowing
+	 */
+	if (grain > (ULONG_MAX - count) / CONFIG_PARALLEL_MAX_CPUS)
+		cpus = 1;
+	else
+		cpus = min_t(ulong, parallel_num_cpus(),
+			     DIV_ROUND_UP(count, grain));
+	if (cpus > 1) {
+		ret = arch_parallel_run(cpus, par_worker, &ctx);
+		if (!ret)
+			return 0;
+		if (ret != -ENOSYS)
+			return log_msg_ret("run", ret);
+		log_debug("No parallel support, running on one CPU\n");
+	}
+	par_worker(&ctx, 0);
+
+	return 0;
+}
@@ -6,6 +6,7 @@
 #ifndef USE_HOSTCC
 #include <fdtdec.h>
 #include <log.h>
+#include <malloc.h>
 #include <asm/types.h>
 #include <asm/byteorder.h>
 #include <linux/errno.h>
@@ -131,6 +132,164 @@ static void montgomery_mul(const struct rsa_public_key *key,
 		montgomery_mul_add_step(key, result, a[i], b);
 }
 
+#ifdef __SIZEOF_INT128__
+/*
+ * When the compiler supports 128-bit integers it can do a 64x64->128 multiply
+ * in one or two instructions. Working with 64-bit words then needs a quarter
+ * of the multiplies and half the loop iterations of the code above.
+ */
+#define RSA_MONT64
+
+typedef unsigned __int128 uint128_t;
+
+/**
+ * struct rsa_key64 - RSA key with the modulus as 64-bit words
+ *
+ * @len:	Length of @modulus in 64-bit words
+ * @n0inv:	-1 / modulus[0] mod 2^64
+ * @modulus:	Modulus as little endian word array
+ */
+struct rsa_key64 {
+	uint len;
+	uint64_t n0inv;
+	uint64_t *modulus;
+};
+
+/**
+ * subtract_modulus64() - subtract modulus from the given value
+ *
+ * @key:	Key containing modulus to subtract
+ * @num:	Number to subtract modulus from, as little endian word array
+ */
+static void subtract_modulus64(const struct rsa_key64 *key, uint64_t num[])
+{
+	uint64_t borrow = 0, n, m;
+	uint i;
+
+	for (i = 0; i < key->len; i++) {
+		n = num[i];
+		m = key->modulus[i];
+		num[i] = n - m - borrow;
+		borrow = (n < m) | (n - m < borrow);
+	}
+}
+
+/**
+ * greater_equal_modulus64() - check if a value is >= modulus
+ *
+ * @key:	Key containing modulus to check
+ * @num:	Number to check against modulus, as little endian word array
+ * Return: 0 if num < modulus, 1 if num >= modulus
+ */
+static int greater_equal_modulus64(const struct rsa_key64 *key,
+				   uint64_t num[])
+{
+	int i;
+
+	for (i = (int)key->len - 1; i >= 0; i--) {
+		if (num[i] < key->modulus[i])
+			return 0;
+		if (num[i] > key->modulus[i])
+			return 1;
+	}
+
+	return 1;  /* equal */
+}
+
+/**
+ * montgomery_mul_add_step64() - Perform montgomery multiply-add step
+ *
+ * This is the same as montgomery_mul_add_step() but with 64-bit words. The
+ * accumulators cannot overflow since (2^64 - 1)^2 + 2 * (2^64 - 1) is
+ * 2^128 - 1.
+ *
+ * @key:	RSA key
+ * @result:	Place to put result, as little endian word array
+ * @a:		Multiplier
+ * @b:		Multiplicand, as little endian word array
+ */
+static void montgomery_mul_add_step64(const struct rsa_key64 *key,
+				      uint64_t result[], const uint64_t a,
+				      const uint64_t b[])
+{
+	uint128_t acc_a, acc_b;
+	uint64_t d0;
+	uint i;
+
+	acc_a = (uint128_t)a * b[0] + result[0];
+	d0 = (uint64_t)acc_a * key->n0inv;
+	acc_b = (uint128_t)d0 * key->modulus[0] + (uint64_t)acc_a;
+	for (i = 1; i < key->len; i++) {
+		acc_a = (acc_a >> 64) + (uint128_t)a * b[i] + result[i];
+		acc_b = (acc_b >> 64) + (uint128_t)d0 * key->modulus[i] +
+				(uint64_t)acc_a;
+		result[i - 1] = (uint64_t)acc_b;
+	}
+
+	acc_a = (acc_a >> 64) + (acc_b >> 64);
+
+	result[i - 1] = (uint64_t)acc_a;
+
+	if (acc_a >> 64)
+		subtract_modulus64(key, result);
+}
+
+/**
+ * montgomery_mul64() - Perform montgomery multiply with 64-bit words
+ *
+ * Operation: montgomery result[] = a[] * b[] / n0inv % modulus
+ *
+ * @key:	RSA key
+ * @result:	Place to put result, as little endian word array
+ * @a:		Multiplier, as little endian word array
+ * @b:		Multiplicand, as little endian word array
+ */
+static void montgomery_mul64(const struct rsa_key64 *key, uint64_t result[],
+			     const uint64_t a[], const uint64_t b[])
+{
+	uint i;
+
+	memset(result, '\0', key->len * sizeof(result[0]));
+	for (i = 0; i < key->len; ++i)
+		montgomery_mul_add_step64(key, result, a[i], b);
+}
+
+/**
+ * words_to_64() - Convert a 32-bit word array to 64-bit words
+ *
+ * @dst:	Place to put the result, as little endian 64-bit word array
+ * @src:	Value to convert, as little endian 32-bit word array
+ * @len:	Length of @dst in 64-bit words
+ */
+static void words_to_64(uint64_t dst[], const uint32_t src[], uint len)
+{
+	uint i;
+
+	for (i = 0; i < len; i++)
+		dst[i] = src[2 * i] | (uint64_t)src[2 * i + 1] << 32;
+}
+
+/**
+ * calc_n0inv64() - Calculate -1 / n mod 2^64
+ *
+ * This uses Newton's method, which doubles the number of correct bits on each
+ * step. Starting with n itself gives 3 correct bits since n is odd.
+ *
+ * @n:		Bottom word of the modulus
+ * Return: -1 / n mod 2^64
+ */
+static uint64_t calc_n0inv64(uint64_t n)
+{
+	uint64_t inv = n;
+	int i;
+
+	for (i = 0; i < 5; i++)
+		inv *= 2 - n * inv;
+
+	return -inv;
+}
+#endif /* __SIZEOF_INT128__ */
+
 /**
  * num_pub_exponent_bits() - Number of bits in the public exponent
  *
@@ -173,6 +332,98 @@ static int is_public_exponent_bit_set(const struct rsa_public_key *key,
 	return key->exponent & (1ULL << pos);
 }
 
+#if !defined(USE_HOSTCC) && defined(CONFIG_UNIT_TEST)
+static bool rsa_force_32bit;
+
+void rsa_mod_exp_set_32bit(bool force)
+{
+	rsa_force_32bit = force;
+}
+#else
+#define rsa_force_32bit	false
+#endif
+
+#ifdef RSA_MONT64
+/**
+ * pow_mod64() - public exponentiation using 64-bit words
+ *
+ * This follows pow_mod(), which checks the key and exponent before calling
+ * this function.
+ *
+ * @key:	RSA key
+ * @val:	Value to raise, as little endian word array
+ * @result:	Place to put the result, as little endian word array
+ * @k:		Number of bits in the public exponent
+ * Return: true if done, false if the key has an odd number of 32-bit words,
+ * there is not enough memory or the 32-bit code has been selected for testing
+ */
+static bool pow_mod64(const struct rsa_public_key *key, const uint32_t *val,
+		      uint32_t *result, int k)
+{
+	uint len = key->len / 2;
+	uint64_t *mod, *rr, *val64, *acc, *tmp, *a_scaled;
+	struct rsa_key64 key64;
+	uint i;
+	int j;
+
+	if ((key->len & 1) || rsa_force_32bit)
+		return false;
+
+	/*
+	 * This needs a few KB for a large key, on top of what pow_mod() uses,
+	 * so keep it off the stack, which is small in SPL
+	 */
+	mod = malloc(6 * len * sizeof(uint64_t));
+	if (!mod)
+		return false;
+	rr = mod + len;
+	val64 = rr + len;
+	acc = val64 + len;
+	tmp = acc + len;
+	a_scaled = tmp + len;
+
+	words_to_64(mod, key->modulus, len);
+	words_to_64(rr, key->rr, len);
+	words_to_64(val64, val, len);
+	key64.len = len;
+	key64.modulus = mod;
+	key64.n0inv = calc_n0inv64(mod[0]);
+
+	/* the bit at e[k-1] is 1 by definition, so start with: C := M */
+	montgomery_mul64(&key64, acc, val64, rr);
+	memcpy(a_scaled, acc, len * sizeof(uint64_t));
+
+	for (j = k - 2; j > 0; --j) {
+		montgomery_mul64(&key64, tmp, acc, acc);
+		if (is_public_exponent_bit_set(key, j))
+			montgomery_mul64(&key64, acc, tmp, a_scaled);
+		else
+			memcpy(acc, tmp, len * sizeof(uint64_t));
+	}
+
+	/* the bit at e[0] is always 1 */
+	montgomery_mul64(&key64, tmp, acc, acc);
+	montgomery_mul64(&key64, acc, tmp, val64);
+
+	if (greater_equal_modulus64(&key64, acc))
+		subtract_modulus64(&key64, acc);
+
+	for (i = 0; i < len; i++) {
+		result[2 * i] = (uint32_t)acc[i];
+		result[2 * i + 1] = acc[i] >> 32;
+	}
+	free(mod);
+
+	return true;
+}
+#else
+static bool pow_mod64(const struct rsa_public_key *key, const uint32_t *val,
+		      uint32_t *result, int k)
+{
+	return false;
+}
+#endif
+
 /**
  * pow_mod() - in-place public exponentiation
  *
@@ -214,6 +465,9 @@ static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
 		return -EINVAL;
 	}
 
+	if (pow_mod64(key, val, result, k))
+		goto done;
+
 	/* the bit at e[k-1] is 1 by definition, so start with: C := M */
 	montgomery_mul(key, acc, val, key->rr); /* acc = a * RR / R mod n */
 	/* retain scaled version for intermediate use */
@@ -240,6 +494,7 @@ static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
 	if (greater_equal_modulus(key, result))
 		subtract_modulus(key, result);
 
+done:
 	/* Convert to bigendian byte array */
 	for (i = key->len - 1, ptr = inout; (int)i >= 0; i--, ptr++)
 		put_unaligned_be32(result[i], ptr);
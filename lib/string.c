@@ -512,16 +512,12 @@ char *strswab(const char *s)
 }
 #endif
 
-#ifndef __HAVE_ARCH_MEMSET
-/**
- * memset - Fill a region of memory with the given value
- * @s: Pointer to the start of the area.
- * @c: The byte to fill the area with
- * @count: The size of the area.
- *
- * Do not use memset() to access IO space, use memset_io() instead.
+/*
+ * The portable memset(), memcpy() and memmove() are also built for unit
+ * tests when the architecture has its own, so that the two can be compared
  */
-__used void * memset(void * s,int c,size_t count)
+#if !defined(__HAVE_ARCH_MEMSET) || CONFIG_IS_ENABLED(UNIT_TEST)
+static __always_inline void *__memset_generic(void *s, int c, size_t count)
 {
 	unsigned long *sl = (unsigned long *) s;
 	char *s8;
@@ -550,17 +546,24 @@ __used void * memset(void * s,int c,size_t count)
 }
 #endif
 
-#ifndef __HAVE_ARCH_MEMCPY
+#ifndef __HAVE_ARCH_MEMSET
 /**
- * memcpy - Copy one area of memory to another
- * @dest: Where to copy to
- * @src: Where to copy from
+ * memset - Fill a region of memory with the given value
+ * @s: Pointer to the start of the area.
+ * @c: The byte to fill the area with
  * @count: The size of the area.
  *
- * You should not use this function to access IO space, use memcpy_toio()
- * or memcpy_fromio() instead.
+ * Do not use memset() to access IO space, use memset_io() instead.
  */
-__used void * memcpy(void *dest, const void *src, size_t count)
+__used void * memset(void * s,int c,size_t count)
+{
+	return __memset_generic(s, c, count);
+}
+#endif
+
+#if !defined(__HAVE_ARCH_MEMCPY) || CONFIG_IS_ENABLED(UNIT_TEST)
+static __always_inline void *__memcpy_generic(void *dest, const void *src,
+					      size_t count)
 {
 	unsigned long *dl = (unsigned long *)dest, *sl = (unsigned long *)src;
 	char *d8, *s8;
@@ -585,16 +588,25 @@ __used void * memcpy(void *dest, const void *src, size_t count)
 }
 #endif
 
-#ifndef __HAVE_ARCH_MEMMOVE
+#ifndef __HAVE_ARCH_MEMCPY
 /**
- * memmove - Copy one area of memory to another
+ * memcpy - Copy one area of memory to another
  * @dest: Where to copy to
  * @src: Where to copy from
  * @count: The size of the area.
  *
- * Unlike memcpy(), memmove() copes with overlapping areas.
+ * You should not use this function to access IO space, use memcpy_toio()
+ * or memcpy_fromio() instead.
  */
-__used void * memmove(void * dest,const void *src,size_t count)
+__used void * memcpy(void *dest, const void *src, size_t count)
+{
+	return __memcpy_generic(dest, src, count);
+}
+#endif
+
+#if !defined(__HAVE_ARCH_MEMMOVE) || CONFIG_IS_ENABLED(UNIT_TEST)
+static __always_inline void *__memmove_generic(void *dest, const void *src,
+					       size_t count)
 {
 	char *tmp, *s;
 
@@ -623,6 +635,38 @@ __used void * memmove(void * dest,const void *src,size_t count)
 }
 #endif
 
+#ifndef __HAVE_ARCH_MEMMOVE
+/**
+ * memmove - Copy one area of memory to another
+ * @dest: Where to copy to
+ * @src: Where to copy from
+ * @count: The size of the area.
+ *
+ * Unlike memcpy(), memmove() copes with overlapping areas.
+ */
+__used void * memmove(void * dest,const void *src,size_t count)
+{
+	return __memmove_generic(dest, src, count);
+}
+#endif
+
+#if CONFIG_IS_ENABLED(UNIT_TEST)
+void *memset_generic(void *s, int c, size_t count)
+{
+	return __memset_generic(s, c, count);
+}
+
+void *memcpy_generic(void *dest, const void *src, size_t count)
+{
+	return __memcpy_generic(dest, src, count);
+}
+
+void *memmove_generic(void *dest, const void *src, size_t count)
+{
+	return __memmove_generic(dest, src, count);
+}
+#endif
+
 #ifndef __HAVE_ARCH_MEMCMP
 /**
  * memcmp - Compare two areas of memory
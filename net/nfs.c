@@ -32,6 +32,7 @@
 
 #include <command.h>
 #include <display_options.h>
+#include <env.h>
 #ifdef CONFIG_SYS_DIRECT_FLASH_NFS
 #include <flash.h>
 #endif
@@ -50,12 +51,52 @@
 #define NFS_RPC_ERR	1
 #define NFS_RPC_DROP	124
 
+#define NFS_MAX_WINDOW	16	/* Largest number of reads in flight */
+#define NFS_V2_MAXDATA	8192	/* Largest read allowed by NFSv2 */
+#define NFS_MIN_READ_SIZE	512
+#define NFS_HASH_BYTES	((NFS_READ_SIZE / 2) * 10)	/* Bytes per hash */
+
+/* Bytes before the data in a READ reply, with the largest attributes */
+#define NFS_READ_HDR_SIZE	((6 + NFS_MAX_ATTRS) * sizeof(uint32_t))
+
+/* Largest read whose reply fits in the receive buffer */
+#ifdef CONFIG_IP_DEFRAG
+#define NFS_MAX_READ_SIZE	rounddown(CONFIG_NET_MAXDEFRAG - \
+					  IP_UDP_HDR_SIZE - NFS_READ_HDR_SIZE, \
+					  NFS_READ_SIZE)
+#else
+#define NFS_MAX_READ_SIZE	NFS_READ_SIZE
+#endif
+
+/**
+ * struct nfs_read - A READ request which has been sent to the server
+ *
+ * @id: RPC transaction ID of the request
+ * @offset: File offset of the data requested
+ * @len: Number of bytes requested, or 0 if this slot is not in use
+ */
+struct nfs_read {
+	ulong id;
+	uint offset;
+	uint len;
+};
+
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
 static const ulong nfs_timeout = CONFIG_NFS_TIMEOUT;
 
+static struct nfs_read nfs_reads[NFS_MAX_WINDOW];
+static uint nfs_window;		/* Number of reads to keep in flight */
+static uint nfs_window_size;	/* ...once the first read has succeeded */
+static uint nfs_read_size;	/* Number of bytes to request in each read */
+static uint nfs_read_next;	/* File offset of the next read to send */
+static uint nfs_file_end;	/* Size of the file, once nfs_eof is set */
+static bool nfs_eof;		/* The end of the file has been seen */
+static uint nfs_bytes;		/* Number of bytes received */
+static uint nfs_hashes;		/* Number of progress hashes printed */
+static uint nfs_resent;		/* Number of reads sent again */
+static ulong nfs_time_start;
+
 static char dirfh[NFS3_FHSIZE]; /* NFSv2 / NFSv3 file handle of directory */
 static unsigned int dirfh3_length; /* (variable) length of dirfh when NFSv3 */
 static char filefh[NFS3_FHSIZE]; /* NFSv2 / NFSv3 file handle */
@@ -425,6 +466,84 @@ static void nfs_read_req(int offset, int readlen)
 	rpc_req(PROG_NFS, NFS_READ, data, len);
 }
 
+/**
+ * nfs_read_send() - Send a READ request and record it in a slot
+ *
+ * @rd: Slot to use
+ * @offset: File offset to read from
+ * @len: Number of bytes to read
+ */
+static void nfs_read_send(struct nfs_read *rd, uint offset, uint len)
+{
+	nfs_read_req(offset, len);
+	rd->id = rpc_id;
+	rd->offset = offset;
+	rd->len = len;
+}
+
+/* Send reads until the window is full or the end of the file is reached */
+static void nfs_read_fill(void)
+{
+	int i;
+
+	for (i = 0; i < nfs_window; i++) {
+		struct nfs_read *rd = &nfs_reads[i];
+
+		if (rd->len)
+			continue;
+		if (nfs_eof && nfs_read_next >= nfs_file_end)
+			break;
+		nfs_read_send(rd, nfs_read_next, nfs_read_size);
+		nfs_read_next += nfs_read_size;
+	}
+}
+
+/* Send all reads which are still waiting for a reply again */
+static void nfs_read_resend(void)
+{
+	int i;
+
+	for (i = 0; i < nfs_window; i++) {
+		struct nfs_read *rd = &nfs_reads[i];
+
+		if (rd->len) {
+			nfs_read_send(rd, rd->offset, rd->len);
+			nfs_resent++;
+		}
+	}
+}
+
+/* Work out the read size and window, then send the first read */
+static void nfs_read_start(void)
+{
+	ulong max = NFS_MAX_READ_SIZE;
+
+	if (choosen_nfs_version != NFS_V3)
+		max = min_t(ulong, max, NFS_V2_MAXDATA);
+	nfs_read_size = clamp_t(ulong, env_get_ulong("nfsreadsize", 10,
+						     CONFIG_NFS_READ_SIZE),
+				NFS_MIN_READ_SIZE, max);
+	nfs_window_size = clamp_t(ulong, env_get_ulong("nfswindowsize", 10,
+						       CONFIG_NFS_WINDOWSIZE),
+				  1, NFS_MAX_WINDOW);
+	debug("NFS read size %u, window %u\n", nfs_read_size, nfs_window_size);
+
+	/*
+	 * Send a single read to start with, since an error here means that
+	 * the file is a symlink
+	 */
+	memset(nfs_reads, '\0', sizeof(nfs_reads));
+	nfs_window = 1;
+	nfs_read_next = 0;
+	nfs_eof = false;
+	nfs_bytes = 0;
+	nfs_hashes = 0;
+	nfs_resent = 0;
+	nfs_time_start = get_timer(0);
+	nfs_state = STATE_READ_REQ;
+	nfs_read_fill();
+}
+
 /**************************************************************************
 RPC request dispatcher
 **************************************************************************/
@@ -455,7 +574,7 @@ static void nfs_send(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_resend();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -711,20 +830,43 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 	return 0;
 }
 
-static int nfs_read_reply(uchar *pkt, unsigned len)
+/**
+ * nfs_read_reply() - Handle the reply to a READ request
+ *
+ * The data is stored directly from @pkt, so only the header is copied
+ *
+ * @pkt: Reply packet
+ * @len: Length of @pkt in bytes
+ * @rdp: Returns the slot of the read which this is a reply to
+ * @eofp: Returns true if the server reports the end of the file
+ * Return: number of bytes read, -NFS_RPC_DROP if this is not a reply to any
+ *	read in flight, or another negative value on error
+ */
+static int nfs_read_reply(uchar *pkt, unsigned len, struct nfs_read **rdp,
+			  bool *eofp)
 {
 	struct rpc_t rpc_pkt;
+	struct nfs_read *rd;
+	ulong id;
 	int rlen;
 	uchar *data_ptr;
+	int i;
 
 	debug("%s\n", __func__);
 
-	memcpy(&rpc_pkt.u.data[0], pkt, sizeof(rpc_pkt.u.reply));
+	memset(&rpc_pkt, '\0', NFS_READ_HDR_SIZE);
+	memcpy(&rpc_pkt.u.data[0], pkt, min_t(uint, len, NFS_READ_HDR_SIZE));
 
-	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
-		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+	id = ntohl(rpc_pkt.u.reply.id);
+	for (i = 0, rd = NULL; i < nfs_window; i++) {
+		if (nfs_reads[i].len && nfs_reads[i].id == id) {
+			rd = &nfs_reads[i];
+			break;
+		}
+	}
+	if (!rd)
 		return -NFS_RPC_DROP;
+	*rdp = rd;
 
 	if (rpc_pkt.u.reply.rstatus  ||
 	    rpc_pkt.u.reply.verifier ||
@@ -737,21 +879,17 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
-		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
-		putc('#');
-
 	if (choosen_nfs_version != NFS_V3) {
 		rlen = ntohl(rpc_pkt.u.reply.data[18]);
 		data_ptr = (uchar *)&(rpc_pkt.u.reply.data[19]);
+		*eofp = !rlen;
 	} else {  /* NFS_V3 */
 		int nfsv3_data_offset =
 			nfs3_get_attributes_offset(rpc_pkt.u.reply.data);
 
 		/* count value */
 		rlen = ntohl(rpc_pkt.u.reply.data[1 + nfsv3_data_offset]);
+		*eofp = rpc_pkt.u.reply.data[2 + nfsv3_data_offset] || !rlen;
 		/* Skip unused values :
 			EOF:		32 bits value,
 			data_size:	32 bits value,
@@ -760,15 +898,82 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 			&(rpc_pkt.u.reply.data[4 + nfsv3_data_offset]);
 	}
 
-	if (((uchar *)&(rpc_pkt.u.reply.data[0]) - (uchar *)(&rpc_pkt) + rlen) > len)
-			return -9999;
+	/* Point into the packet, not the copy of the header */
+	data_ptr = pkt + (data_ptr - (uchar *)&rpc_pkt);
+	if (rlen < 0 || rlen > rd->len || data_ptr - pkt + rlen > len)
+		return -9999;
 
-	if (store_block(data_ptr, nfs_offset, rlen))
-			return -9999;
+	if (store_block(data_ptr, rd->offset, rlen))
+		return -9999;
 
 	return rlen;
 }
 
+/* Print a hash for every NFS_HASH_BYTES bytes received */
+static void nfs_show_progress(uint rlen)
+{
+	nfs_bytes += rlen;
+	while (nfs_bytes && nfs_hashes <= (nfs_bytes - 1) / NFS_HASH_BYTES) {
+		if (nfs_hashes && !(nfs_hashes % HASHES_PER_LINE))
+			puts("\n\t ");
+		putc('#');
+		nfs_hashes++;
+	}
+}
+
+/**
+ * nfs_read_done() - Record a successful read and send more
+ *
+ * If the server returns less data than requested without reaching the end of
+ * the file, the rest is requested again and the smaller size is used for the
+ * following reads. Once no reads are left in flight, the file is unmounted.
+ *
+ * @rd: Slot of the read
+ * @rlen: Number of bytes received
+ * @eof: true if the server reports the end of the file
+ */
+static void nfs_read_done(struct nfs_read *rd, uint rlen, bool eof)
+{
+	uint end = rd->offset + rlen;
+	ulong time;
+	int i;
+
+	nfs_show_progress(rlen);
+	if (eof) {
+		if (!nfs_eof || end < nfs_file_end)
+			nfs_file_end = end;
+		nfs_eof = true;
+		rd->len = 0;
+	} else if (rlen < rd->len) {
+		if (rlen >= NFS_MIN_READ_SIZE && rlen < nfs_read_size) {
+			nfs_read_size = rounddown(rlen, NFS_MIN_READ_SIZE);
+			debug("NFS read size reduced to %u\n", nfs_read_size);
+		}
+		nfs_read_send(rd, end, rd->len - rlen);
+	} else {
+		rd->len = 0;
+	}
+
+	nfs_window = nfs_window_size;
+	nfs_read_fill();
+
+	for (i = 0; i < nfs_window; i++) {
+		if (nfs_reads[i].len)
+			return;
+	}
+
+	time = get_timer(nfs_time_start);
+	if (time > 0) {
+		puts("\n\t ");
+		print_size(nfs_file_end / time * 1000, "/s");
+	}
+	if (nfs_resent)
+		printf(", %u reads resent", nfs_resent);
+	nfs_download_state = NETLOOP_SUCCESS;
+	nfs_state = STATE_UMOUNT_REQ;
+	nfs_send();
+}
+
 /**************************************************************************
 Interfaces of U-BOOT
 **************************************************************************/
@@ -789,12 +994,15 @@ static void nfs_timeout_handler(void)
 static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			unsigned src, unsigned len)
 {
+	struct nfs_read *rd;
+	bool eof;
 	int rlen;
 	int reply;
 
 	debug("%s\n", __func__);
 
-	if (len > sizeof(struct rpc_t))
+	/* Read replies are not copied, so may be larger */
+	if (len > sizeof(struct rpc_t) && nfs_state != STATE_READ_REQ)
 		return;
 
 	if (dest != nfs_our_port)
@@ -864,10 +1072,7 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			nfs_state = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
 			nfs_send();
 		} else {
-			nfs_state = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
-			nfs_send();
+			nfs_read_start();
 		}
 		break;
 
@@ -890,22 +1095,18 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		break;
 
 	case STATE_READ_REQ:
-		rlen = nfs_read_reply(pkt, len);
+		rlen = nfs_read_reply(pkt, len, &rd, &eof);
 		if (rlen == -NFS_RPC_DROP)
 			break;
 		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
-		if (rlen > 0) {
-			nfs_offset += rlen;
-			nfs_send();
+		if (rlen >= 0) {
+			nfs_read_done(rd, rlen, eof);
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			nfs_state = STATE_READLINK_REQ;
 			nfs_send();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
-			if (rlen < 0)
-				debug("NFS READ error (%d)\n", rlen);
+			debug("NFS READ error (%d)\n", rlen);
 			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		}
@@ -10,6 +10,7 @@
 #include <dm.h>
 #include <bootdev.h>
 #include <bootflow.h>
+#include <bootstage.h>
 #include <mapmem.h>
 #include <os.h>
 #include <test/suites.h>
@@ -392,6 +393,45 @@ static int bootdev_test_hunter(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootdev_test_hunter, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
 
+/* Check starting hunters in the background */
+static int bootdev_test_hunt_ahead(struct unit_test_state *uts)
+{
+	struct bootstd_priv *std;
+	ulong start;
+
+	usb_started = false;
+	test_set_skip_delays(true);
+	ut_assertok(bootstd_get_priv(&std));
+
+	/* USB is the only hunter with a start() method; it is bit 8 */
+	bootdev_hunt_ahead(NULL, false);
+	ut_asserteq(BIT(8), std->hunters_started);
+	ut_asserteq(0, std->hunters_used);
+	ut_asserteq(0, std->hunt_ahead_us);
+
+	start = timer_get_boot_us();
+	while (timer_get_boot_us() - start < 1000)
+		;
+
+	/* using another hunter does not count as catching up */
+	ut_assertok(bootdev_hunt("mmc", false));
+	ut_asserteq(BIT(8), std->hunters_started);
+	ut_asserteq(0, std->hunt_ahead_us);
+
+	/* using the started hunter stops the accumulator */
+	ut_assertok(bootdev_hunt("usb", false));
+	ut_asserteq(0, std->hunters_started);
+	ut_assert(std->hunt_ahead_us >= 1000);
+	ut_asserteq(BIT(MMC_HUNTER) | BIT(8), std->hunters_used);
+
+	/* a hunter which has been used is not started again */
+	bootdev_hunt_ahead(NULL, false);
+	ut_asserteq(0, std->hunters_started);
+
+	return 0;
+}
+BOOTSTD_TEST(bootdev_test_hunt_ahead, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
 /* Check 'bootdev hunt' command */
 static int bootdev_test_cmd_hunt(struct unit_test_state *uts)
 {
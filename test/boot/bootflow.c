@@ -13,6 +13,7 @@
 #include <cli.h>
 #include <dm.h>
 #include <efi_default_filename.h>
+#include <env.h>
 #include <expo.h>
 #ifdef CONFIG_SANDBOX
 #include <asm/test.h>
@@ -369,6 +370,64 @@ static int bootflow_iter(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootflow_iter, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
 
+/* Check recording a bootflow and finding it again from the record */
+static int bootflow_cache(struct unit_test_state *uts)
+{
+	struct bootflow_iter iter;
+	struct bootflow bflow;
+	char rec[256], *p;
+	int ret, i;
+
+	bootstd_clear_glob();
+	ut_assertok(env_set("bootflow_cache", NULL));
+
+	/* there is no record yet */
+	ut_asserteq(-ENOENT, bootflow_cache_scan(&iter, 0, &bflow));
+	bootflow_iter_uninit(&iter);
+
+	/* find the extlinux bootflow on mmc1 and record it */
+	ret = bootflow_scan_first(NULL, NULL, &iter, BOOTFLOWIF_SKIP_GLOBAL,
+				  &bflow);
+	for (i = 0; ret && i < 10; i++) {
+		bootflow_free(&bflow);
+		ret = bootflow_scan_next(&iter, &bflow);
+	}
+	ut_assertok(ret);
+	ut_asserteq_str("mmc1.bootdev.part_1", bflow.name);
+	ut_assertok(bootflow_cache_save(&bflow, false));
+	bootflow_free(&bflow);
+	bootflow_iter_uninit(&iter);
+
+	ut_assertnonnull(env_get("bootflow_cache"));
+	strlcpy(rec, env_get("bootflow_cache"), sizeof(rec));
+	ut_asserteq_strn("mmc mmc1.bootdev 1 extlinux /extlinux/extlinux.conf ",
+			 rec);
+
+	/* the record finds the same bootflow without scanning */
+	ut_assertok(bootflow_cache_scan(&iter, 0, &bflow));
+	ut_asserteq_str("mmc1.bootdev.part_1", bflow.name);
+	ut_asserteq_str("extlinux", bflow.method->name);
+	ut_asserteq(BOOTFLOWST_READY, bflow.state);
+	ut_assertok(bootflow_cache_save(&bflow, false));
+	ut_asserteq_str(rec, env_get("bootflow_cache"));
+	bootflow_free(&bflow);
+	bootflow_iter_uninit(&iter);
+
+	/* a record with the wrong CRC is not used */
+	p = strrchr(rec, ' ');
+	ut_assertnonnull(p);
+	strcpy(p, strcmp(p, " 1") ? " 1" : " 2");
+	ut_assertok(env_set("bootflow_cache", rec));
+	ut_asserteq(-ESTALE, bootflow_cache_scan(&iter, 0, &bflow));
+	bootflow_iter_uninit(&iter);
+
+	ut_assertok(env_set("bootflow_cache", NULL));
+	ut_assert_console_end();
+
+	return 0;
+}
+BOOTSTD_TEST(bootflow_cache, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
 #if defined(CONFIG_SANDBOX) && defined(CONFIG_BOOTMETH_GLOBAL)
 /* Check using the system bootdev */
 static int bootflow_system(struct unit_test_state *uts)
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for looking up commands
+ */
+
+#include <command.h>
+#include <env.h>
+#include <time.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Check that find_cmd() agrees with a linear search of the command table */
+static int test_find_cmd(struct unit_test_state *uts)
+{
+	struct cmd_tbl *start = ll_entry_start(struct cmd_tbl, cmd);
+	const int count = ll_entry_count(struct cmd_tbl, cmd);
+	char name[64];
+	int i, len;
+
+	for (i = 0; i < count; i++) {
+		const char *cmd = start[i].name;
+
+		for (len = 1; len <= strlen(cmd) && len < sizeof(name) - 2;
+		     len++) {
+			strlcpy(name, cmd, len + 1);
+			ut_asserteq_ptr(find_cmd_tbl(name, start, count),
+					find_cmd(name));
+			strcat(name, ".b");
+			ut_asserteq_ptr(find_cmd_tbl(name, start, count),
+					find_cmd(name));
+		}
+	}
+
+	/* Every command can be found by its full name */
+	for (i = 0; i < count; i++)
+		ut_assertnonnull(find_cmd(start[i].name));
+
+	ut_assertnull(find_cmd("no-such-command"));
+	ut_assertnull(find_cmd("~"));
+	ut_assertnull(find_cmd(""));
+
+	return 0;
+}
+COMMON_TEST(test_find_cmd, 0);
+
+#define CMD_BENCH_COUNT	1000
+
+/**
+ * test_find_cmd_bench_norun() - benchmark looking up and running commands
+ *
+ * This shows the time taken to look up each command by name, as well as the
+ * time taken to run a small script. Run it with
+ * 'ut common test_find_cmd_bench_norun'.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int test_find_cmd_bench_norun(struct unit_test_state *uts)
+{
+	struct cmd_tbl *start = ll_entry_start(struct cmd_tbl, cmd);
+	const int count = ll_entry_count(struct cmd_tbl, cmd);
+	ulong t0, us;
+	int i, j;
+
+	t0 = timer_get_us();
+	for (j = 0; j < CMD_BENCH_COUNT; j++) {
+		for (i = 0; i < count; i++)
+			ut_assertnonnull(find_cmd(start[i].name));
+	}
+	us = timer_get_us() - t0;
+	printf("%d commands: %lu ns per lookup\n", count,
+	       us * 1000 / (CMD_BENCH_COUNT * count));
+
+	t0 = timer_get_us();
+	for (j = 0; j < CMD_BENCH_COUNT; j++)
+		ut_assertok(run_command_list("setexpr cmdbench 1 + 2; "
+					     "test ${cmdbench} -eq 3; true",
+					     -1, 0));
+	us = timer_get_us() - t0;
+	printf("script: %lu us per run\n", us / CMD_BENCH_COUNT);
+	ut_assertok(env_set("cmdbench", NULL));
+
+	return 0;
+}
+COMMON_TEST(test_find_cmd_bench_norun, UT_TESTF_MANUAL);
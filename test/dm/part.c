@@ -108,6 +108,47 @@ static int dm_test_part_bootable(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_part_bootable, UT_TESTF_SCAN_FDT);
 
+/* Check that a changed GPT is seen after the old one has been looked up */
+static int dm_test_part_gpt_cache(struct unit_test_state *uts)
+{
+	char str_disk_guid[UUID_STR_LEN + 1];
+	struct blk_desc *mmc_dev_desc;
+	struct disk_partition info;
+	struct disk_partition parts[1] = {
+		{
+			.start = 48,
+			.size = 1,
+			.name = "test1",
+		},
+	};
+
+	ut_asserteq(2, blk_get_device_by_str("mmc", "2", &mmc_dev_desc));
+	if (CONFIG_IS_ENABLED(RANDOM_UUID)) {
+		gen_rand_uuid_str(parts[0].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(str_disk_guid, UUID_STR_FORMAT_STD);
+	}
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+
+	/* the second lookup uses the cached table */
+	ut_assertok(part_get_info(mmc_dev_desc, 1, &info));
+	ut_asserteq_str("test1", (char *)info.name);
+	ut_assertok(part_get_info(mmc_dev_desc, 1, &info));
+	ut_asserteq_str("test1", (char *)info.name);
+	ut_asserteq(1, info.size);
+
+	strcpy((char *)parts[0].name, "renamed");
+	parts[0].size = 2;
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+	ut_assertok(part_get_info(mmc_dev_desc, 1, &info));
+	ut_asserteq_str("renamed", (char *)info.name);
+	ut_asserteq(2, info.size);
+
+	return 0;
+}
+DM_TEST(dm_test_part_gpt_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
 static int do_get_info_test(struct unit_test_state *uts,
 			    struct blk_desc *dev_desc, int part, int part_type,
 			    struct disk_partition const *reference)
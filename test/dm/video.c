@@ -230,6 +230,86 @@ static int dm_test_video_chars(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_chars, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+/* Test tracking of the damaged region of the frame buffer */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct vid_bbox *damage;
+	struct udevice *dev;
+	int bytes;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		return -EAGAIN;
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	priv = dev_get_uclass_priv(dev);
+	damage = &priv->damage;
+	bytes = VNBYTES(priv->bpix);
+
+	/* Syncing clears the damage */
+	ut_assertok(video_sync(dev, true));
+	ut_asserteq(0, damage->x1);
+	ut_asserteq(0, damage->y1);
+
+	/* A change within a line just marks the pixels changed */
+	ut_assertok(video_sync_copy(dev, priv->fb + 50 * priv->line_length +
+				    40 * bytes,
+				    priv->fb + 50 * priv->line_length +
+				    60 * bytes));
+	ut_asserteq(40, damage->x0);
+	ut_asserteq(50, damage->y0);
+	ut_asserteq(60, damage->x1);
+	ut_asserteq(51, damage->y1);
+
+	/* Changes are merged; a multi-line change covers the full width */
+	ut_assertok(video_fill_part(dev, 0, 20, 30, 40, priv->colour_fg));
+	ut_asserteq(0, damage->x0);
+	ut_asserteq(20, damage->y0);
+	ut_asserteq(priv->xsize, damage->x1);
+	ut_asserteq(51, damage->y1);
+
+	/* Regions are clipped to the display */
+	ut_assertok(video_sync(dev, true));
+	video_damage(dev, priv->xsize - 10, priv->ysize - 5, 100, 100);
+	ut_asserteq(priv->xsize - 10, damage->x0);
+	ut_asserteq(priv->ysize - 5, damage->y0);
+	ut_asserteq(priv->xsize, damage->x1);
+	ut_asserteq(priv->ysize, damage->y1);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that drawing the cursor updates the copy frame buffer and damage */
+static int dm_test_video_cursor(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+
+	if (!IS_ENABLED(CONFIG_EXPO))
+		return -EAGAIN;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	ut_assertok(vidconsole_select_font(con, "8x16", 0));
+	priv = dev_get_uclass_priv(dev);
+	ut_asserteq(46, compress_frame_buffer(uts, dev));
+
+	/* this checks that the copy frame buffer matches */
+	ut_assertok(video_sync(dev, true));
+	ut_assertok(vidconsole_set_cursor_visible(con, true, 0, 16, 0));
+	ut_assert(compress_frame_buffer(uts, dev) > 46);
+
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		ut_asserteq(16, priv->damage.y0);
+		ut_asserteq(32, priv->damage.y1);
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_video_cursor, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
 #ifdef CONFIG_VIDEO_ANSI
 #define ANSI_ESC "\x1b"
 /* Test handling of ANSI escape sequences */
@@ -603,3 +683,37 @@ static int dm_test_video_truetype_bs(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_video_truetype_bs, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that TrueType glyphs drawn from the cache match freshly rendered ones */
+static int dm_test_video_truetype_cache(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+	const char *test_string = "Criticism may not be agreeable, but it is necessary.";
+	void *copy;
+	int i;
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+
+	/* Render every glyph from scratch to get the expected output */
+	console_truetype_set_cache(false);
+	vidconsole_put_string(con, test_string);
+	console_truetype_set_cache(true);
+	copy = malloc(priv->fb_size);
+	ut_assertnonnull(copy);
+	memcpy(copy, priv->fb, priv->fb_size);
+
+	/* The first time, most glyphs are rendered; the second, all are cached */
+	for (i = 0; i < 2; i++) {
+		ut_assertok(video_clear(dev));
+		vidconsole_set_cursor_pos(con, 0, 0);
+		vidconsole_put_string(con, test_string);
+		ut_assertok(memcmp(copy, priv->fb, priv->fb_size));
+	}
+	free(copy);
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
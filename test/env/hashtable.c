@@ -6,6 +6,7 @@
 
 #include <command.h>
 #include <log.h>
+#include <malloc.h>
 #include <search.h>
 #include <stdio.h>
 #include <vsprintf.h>
@@ -124,3 +125,94 @@ static int env_test_htab_deletes(struct unit_test_state *uts)
 }
 
 ENV_TEST(env_test_htab_deletes, 0);
+
+/* Fill the hashtable well past its initial size and check it grows */
+static int env_test_htab_grow(struct unit_test_state *uts)
+{
+	struct hsearch_data htab;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, hcreate_r(SIZE, &htab));
+
+	ut_assertok(htab_fill(uts, &htab, SIZE * 8));
+	ut_assertok(htab_check_fill(uts, &htab, SIZE * 8));
+	ut_asserteq(SIZE * 8, htab.filled);
+	ut_assert(htab.size > SIZE * 8);
+
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_grow, 0);
+
+/* Check overwriting values and that export follows added / removed keys */
+static int env_test_htab_export(struct unit_test_state *uts)
+{
+	struct hsearch_data htab;
+	struct env_entry item;
+	struct env_entry **sorted;
+	struct env_entry *ritem;
+	char *res = NULL;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, hcreate_r(SIZE, &htab));
+
+	item.callback = NULL;
+	item.flags = 0;
+	item.key = "b";
+	item.data = "a-long-value";
+	ut_asserteq(1, hsearch_r(item, ENV_ENTER, &ritem, &htab, 0));
+	item.key = "a";
+	item.data = "1";
+	ut_asserteq(1, hsearch_r(item, ENV_ENTER, &ritem, &htab, 0));
+
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("a=1\nb=a-long-value\n", res);
+	free(res);
+	res = NULL;
+	sorted = htab.sorted;
+	ut_assertnonnull(sorted);
+
+	/* nothing changed, so the same order is used again */
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("a=1\nb=a-long-value\n", res);
+	ut_asserteq_ptr(sorted, htab.sorted);
+	free(res);
+	res = NULL;
+
+	/* shorter and longer values for existing keys keep the order */
+	item.key = "b";
+	item.data = "2";
+	ut_assert(hsearch_r(item, ENV_ENTER, &ritem, &htab, 0) > 0);
+	item.key = "a";
+	item.data = "a-longer-value-than-before";
+	ut_assert(hsearch_r(item, ENV_ENTER, &ritem, &htab, 0) > 0);
+	ut_asserteq_ptr(sorted, htab.sorted);
+
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("a=a-longer-value-than-before\nb=2\n", res);
+	ut_asserteq_ptr(sorted, htab.sorted);
+	free(res);
+	res = NULL;
+
+	/* a new key needs a new order */
+	item.key = "c";
+	item.data = "3";
+	ut_asserteq(1, hsearch_r(item, ENV_ENTER, &ritem, &htab, 0));
+	ut_assertnull(htab.sorted);
+
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("a=a-longer-value-than-before\nb=2\nc=3\n", res);
+	free(res);
+	res = NULL;
+
+	ut_asserteq(0, hdelete_r("a", &htab, 0));
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("b=2\nc=3\n", res);
+	free(res);
+
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_export, 0);
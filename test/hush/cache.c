@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Tests for the cache of parsed hush scripts
+ */
+
+#include <cli_hush.h>
+#include <command.h>
+#include <env.h>
+#include <test/hush.h>
+#include <test/ut.h>
+#include <asm/global_data.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Check that a cached script behaves the same each time it is run */
+static int hush_test_cache_repeat(struct unit_test_state *uts)
+{
+	uint hits;
+	int i;
+
+	if (!(gd->flags & GD_FLG_HUSH_OLD_PARSER))
+		return -EAGAIN;
+
+	ut_assertok(env_set("cache_n", "0"));
+	ut_assertok(env_set("cache_script",
+			    "setexpr cache_n ${cache_n} + 1; echo n=${cache_n}\n"
+			    "for cache_i in a b; do echo ${cache_i}${cache_n}; done"));
+	console_record_reset_enable();
+	for (i = 1; i <= 3; i++) {
+		hits = hush_parse_cache_hits();
+		ut_assertok(run_command("run cache_script", 0));
+		ut_assert_nextline("n=%d", i);
+		ut_assert_nextline("a%d", i);
+		ut_assert_nextline("b%d", i);
+
+		/* both the 'run' command and the script come from the cache */
+		if (i > 1)
+			ut_asserteq(hits + 2, hush_parse_cache_hits());
+	}
+	ut_assert_console_end();
+
+	/* a changed script must be parsed again */
+	ut_assertok(env_set("cache_script", "echo changed"));
+	ut_assertok(run_command("run cache_script", 0));
+	ut_assert_nextline("changed");
+	ut_assert_console_end();
+
+	/* a failing command gives the same result each time */
+	ut_assertok(env_set("cache_script", "echo one; false"));
+	for (i = 0; i < 2; i++) {
+		ut_asserteq(1, run_command("run cache_script", 0));
+		ut_assert_nextline("one");
+	}
+	ut_assert_console_end();
+
+	ut_assertok(env_set("cache_n", NULL));
+	ut_assertok(env_set("cache_script", NULL));
+
+	return 0;
+}
+HUSH_TEST(hush_test_cache_repeat, 0);
+
+/* Check that a script can run itself while it is cached */
+static int hush_test_cache_recurse(struct unit_test_state *uts)
+{
+	int i;
+
+	if (!(gd->flags & GD_FLG_HUSH_OLD_PARSER))
+		return -EAGAIN;
+
+	ut_assertok(env_set("cache_script",
+			    "if test ${cache_d} -lt 2; then "
+			    "setexpr cache_d ${cache_d} + 1; run cache_script; "
+			    "fi; echo d=${cache_d}"));
+	console_record_reset_enable();
+	for (i = 0; i < 2; i++) {
+		ut_assertok(env_set("cache_d", "0"));
+		ut_assertok(run_command("run cache_script", 0));
+		ut_assert_nextline("d=2");
+		ut_assert_nextline("d=2");
+		ut_assert_nextline("d=2");
+	}
+	ut_assert_console_end();
+
+	ut_assertok(env_set("cache_d", NULL));
+	ut_assertok(env_set("cache_script", NULL));
+
+	return 0;
+}
+HUSH_TEST(hush_test_cache_recurse, 0);
+
+/* Check that the least recently used script is dropped from the cache */
+static int hush_test_cache_evict(struct unit_test_state *uts)
+{
+	uint hits;
+	int i;
+
+	if (!(gd->flags & GD_FLG_HUSH_OLD_PARSER))
+		return -EAGAIN;
+
+	console_record_reset_enable();
+	for (i = 0; i <= CONFIG_HUSH_PARSE_CACHE_ENTRIES; i++) {
+		ut_assertok(run_commandf("echo evict%d", i));
+		ut_assert_nextline("evict%d", i);
+	}
+
+	/* the most recent script is still there */
+	hits = hush_parse_cache_hits();
+	ut_assertok(run_commandf("echo evict%d",
+				 CONFIG_HUSH_PARSE_CACHE_ENTRIES));
+	ut_assert_nextline("evict%d", CONFIG_HUSH_PARSE_CACHE_ENTRIES);
+	ut_asserteq(hits + 1, hush_parse_cache_hits());
+
+	/* the first one has been replaced */
+	ut_assertok(run_commandf("echo evict%d", 0));
+	ut_assert_nextline("evict0");
+	ut_asserteq(hits + 1, hush_parse_cache_hits());
+	ut_assert_console_end();
+
+	return 0;
+}
+HUSH_TEST(hush_test_cache_evict, 0);
+
+/* Check that scripts which exit or fail to parse are not kept */
+static int hush_test_cache_uncached(struct unit_test_state *uts)
+{
+	uint hits;
+	int i;
+
+	if (!(gd->flags & GD_FLG_HUSH_OLD_PARSER))
+		return -EAGAIN;
+
+	console_record_reset_enable();
+	hits = hush_parse_cache_hits();
+	for (i = 0; i < 2; i++) {
+		ut_assertok(run_command("echo exiting; exit", 0));
+		ut_assert_nextline("exiting");
+	}
+	ut_assert_console_end();
+	ut_asserteq(hits, hush_parse_cache_hits());
+
+	/* an unterminated 'if' is a syntax error */
+	for (i = 0; i < 2; i++) {
+		ut_asserteq(1, run_command("if true; then echo bad", 0));
+		console_record_reset();
+	}
+	ut_asserteq(hits, hush_parse_cache_hits());
+
+	/* a good script run the same way is kept */
+	ut_assertok(run_command("echo good", 0));
+	ut_assert_nextline("good");
+	hits = hush_parse_cache_hits();
+	ut_assertok(run_command("echo good", 0));
+	ut_assert_nextline("good");
+	ut_assert_console_end();
+	ut_asserteq(hits + 1, hush_parse_cache_hits());
+
+	return 0;
+}
+HUSH_TEST(hush_test_cache_uncached, 0);
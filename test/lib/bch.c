@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for the software BCH encoder / decoder
+ */
+
+#include <malloc.h>
+#include <time.h>
+#include <linux/bch.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+#define BCH_STEP	512
+#define BCH_M		13
+
+/* simple generator so that the tests are repeatable */
+static uint bch_rand(uint *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+
+	return *seed >> 8;
+}
+
+/**
+ * flip_bits() - Flip some distinct bits in a data buffer
+ *
+ * @data:	Buffer to change
+ * @count:	Number of bits to flip
+ * @seed:	Random-number seed
+ */
+static void flip_bits(u8 *data, int count, uint *seed)
+{
+	uint pos[count];
+	int i, j;
+
+	for (i = 0; i < count; i++) {
+		do {
+			pos[i] = bch_rand(seed) % (BCH_STEP * 8);
+			for (j = 0; j < i && pos[j] != pos[i]; j++)
+				;
+		} while (j < i);
+		data[pos[i] / 8] ^= 1 << (pos[i] % 8);
+	}
+}
+
+/**
+ * check_decode() - Corrupt, decode and correct a step of data
+ *
+ * @uts:	Unit test state
+ * @bch:	BCH control structure
+ * @orig:	Original data
+ * @ecc:	ECC for @orig
+ * @errs:	Number of bits to flip
+ * @seed:	Random-number seed
+ * Return:	0 if OK, 1 on failure
+ */
+static int check_decode(struct unit_test_state *uts, struct bch_control *bch,
+			const u8 *orig, const u8 *ecc, int errs, uint *seed)
+{
+	u8 data[BCH_STEP], calc_ecc[bch->ecc_bytes];
+	uint errloc[bch->t];
+	int i, count;
+
+	memcpy(data, orig, BCH_STEP);
+	flip_bits(data, errs, seed);
+	memset(calc_ecc, '\0', bch->ecc_bytes);
+	encode_bch(bch, data, BCH_STEP, calc_ecc);
+
+	count = decode_bch(bch, NULL, BCH_STEP, ecc, calc_ecc, NULL, errloc);
+	ut_asserteq(errs, count);
+	for (i = 0; i < count; i++) {
+		ut_assert(errloc[i] < BCH_STEP * 8);
+		data[errloc[i] / 8] ^= 1 << (errloc[i] % 8);
+	}
+	ut_asserteq_mem(orig, data, BCH_STEP);
+
+	return 0;
+}
+
+/* Test correcting up to t errors, for a few values of t */
+static int lib_bch_decode(struct unit_test_state *uts)
+{
+	static const int tvals[] = {1, 4, 8, 16};
+	struct bch_control *bch;
+	u8 orig[BCH_STEP];
+	uint seed = 1;
+	int i, t, errs, rep;
+
+	for (i = 0; i < BCH_STEP; i++)
+		orig[i] = bch_rand(&seed);
+
+	for (i = 0; i < ARRAY_SIZE(tvals); i++) {
+		t = tvals[i];
+		bch = init_bch(BCH_M, t, 0);
+		ut_assertnonnull(bch);
+		u8 ecc[bch->ecc_bytes];
+
+		memset(ecc, '\0', bch->ecc_bytes);
+		encode_bch(bch, orig, BCH_STEP, ecc);
+		for (errs = 0; errs <= t; errs++) {
+			for (rep = 0; rep < 8; rep++)
+				ut_assertok(check_decode(uts, bch, orig, ecc,
+							 errs, &seed));
+		}
+		free_bch(bch);
+	}
+
+	return 0;
+}
+LIB_TEST(lib_bch_decode, 0);
+
+#define BCH_BENCH_COUNT	1000
+
+/**
+ * lib_bch_bench_norun() - benchmark encode_bch() and decode_bch()
+ *
+ * This shows the time taken to check a 512-byte step of data with 8-bit
+ * correction, for various numbers of bit errors. Run it with
+ * 'ut -f lib lib_bch_bench_norun'.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_bch_bench_norun(struct unit_test_state *uts)
+{
+	struct bch_control *bch;
+	u8 orig[BCH_STEP];
+	ulong start, us;
+	uint seed = 1;
+	int i, errs;
+
+	for (i = 0; i < BCH_STEP; i++)
+		orig[i] = bch_rand(&seed);
+
+	bch = init_bch(BCH_M, 8, 0);
+	ut_assertnonnull(bch);
+	u8 ecc[bch->ecc_bytes];
+
+	memset(ecc, '\0', bch->ecc_bytes);
+	encode_bch(bch, orig, BCH_STEP, ecc);
+
+	printf("%6s %12s\n", "errors", "ns per step");
+	for (errs = 0; errs <= 8; errs += 2) {
+		start = timer_get_us();
+		for (i = 0; i < BCH_BENCH_COUNT; i++)
+			ut_assertok(check_decode(uts, bch, orig, ecc, errs,
+						 &seed));
+		us = timer_get_us() - start;
+		printf("%6d %12lu\n", errs, us * 1000 / BCH_BENCH_COUNT);
+	}
+	free_bch(bch);
+
+	return 0;
+}
+LIB_TEST(lib_bch_bench_norun, UT_TESTF_MANUAL);
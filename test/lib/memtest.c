@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the block-based memory test engine
+ */
+
+#include <malloc.h>
+#include <memtest.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <linux/sizes.h>
+
+/* Use a size which is not a multiple of the block or chunk size */
+#define TEST_WORDS	(SZ_1M / sizeof(ulong) + 3)
+#define TEST_ADDR	0x100000
+#define TEST_PATTERN	0x5a5aa5a5
+
+/* Test that each test passes on good memory and leaves the right data */
+static int lib_test_memtest(struct unit_test_state *uts)
+{
+	struct memtest_result res;
+	ulong *buf;
+	ulong i;
+
+	buf = malloc(TEST_WORDS * sizeof(ulong));
+	ut_assertnonnull(buf);
+
+	ut_assertok(memtest_run(MEMTEST_ADDR_BITS, buf, TEST_ADDR,
+				TEST_WORDS * sizeof(ulong), TEST_PATTERN,
+				&res));
+	ut_asserteq(0, res.errors);
+	ut_assert(res.bytes > 0);
+
+	ut_assertok(memtest_run(MEMTEST_MOVING_INV, buf, TEST_ADDR,
+				TEST_WORDS * sizeof(ulong), TEST_PATTERN,
+				&res));
+	ut_asserteq(0, res.errors);
+	ut_asserteq_64((u64)TEST_WORDS * sizeof(ulong) * 5, res.bytes);
+	for (i = 0; i < TEST_WORDS; i++)
+		ut_asserteq(TEST_PATTERN, buf[i]);
+
+	ut_assertok(memtest_run(MEMTEST_OWN_ADDR, buf, TEST_ADDR,
+				TEST_WORDS * sizeof(ulong), TEST_PATTERN,
+				&res));
+	ut_asserteq(0, res.errors);
+	for (i = 0; i < TEST_WORDS; i++)
+		ut_asserteq((TEST_ADDR + i * sizeof(ulong)) ^ TEST_PATTERN,
+			    buf[i]);
+
+	ut_asserteq(-EINVAL, memtest_run(MEMTEST_COUNT, buf, TEST_ADDR,
+					 TEST_WORDS * sizeof(ulong),
+					 TEST_PATTERN, &res));
+	ut_asserteq_str("moving inversions", memtest_name(MEMTEST_MOVING_INV));
+	ut_asserteq_str("unknown", memtest_name(MEMTEST_COUNT));
+
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_memtest, 0);
+
+/* Words to corrupt, in different chunks and in reverse order */
+#define TEST_BAD_HI	(TEST_WORDS - 2)
+#define TEST_BAD_LO	(SZ_256K / sizeof(ulong) + 5)
+
+/* Flip a bit in two words after the first pass, as if the writes failed */
+static void memtest_corrupt(ulong *buf, int pass)
+{
+	if (!pass) {
+		buf[TEST_BAD_HI] ^= BIT(3);
+		buf[TEST_BAD_LO] ^= BIT(0);
+	}
+}
+
+/* Test that errors are counted and the lowest one is reported */
+static int lib_test_memtest_fail(struct unit_test_state *uts)
+{
+	struct memtest_result res;
+	ulong *buf;
+	ulong val;
+
+	buf = malloc(TEST_WORDS * sizeof(ulong));
+	ut_assertnonnull(buf);
+	memtest_set_hook(memtest_corrupt);
+
+	ut_assertok(memtest_run(MEMTEST_MOVING_INV, buf, TEST_ADDR,
+				TEST_WORDS * sizeof(ulong), TEST_PATTERN,
+				&res));
+	ut_asserteq(2, res.errors);
+	ut_asserteq(TEST_ADDR + TEST_BAD_LO * sizeof(ulong), res.fail_addr);
+	ut_asserteq(TEST_PATTERN, res.expected);
+	ut_asserteq(TEST_PATTERN ^ BIT(0), res.actual);
+
+	ut_assertok(memtest_run(MEMTEST_OWN_ADDR, buf, TEST_ADDR,
+				TEST_WORDS * sizeof(ulong), TEST_PATTERN,
+				&res));
+	ut_asserteq(2, res.errors);
+	ut_asserteq(TEST_ADDR + TEST_BAD_LO * sizeof(ulong), res.fail_addr);
+	val = res.fail_addr ^ TEST_PATTERN;
+	ut_asserteq(val, res.expected);
+	ut_asserteq(val ^ BIT(0), res.actual);
+
+	/* the hook is not used once removed */
+	memtest_set_hook(NULL);
+	ut_assertok(memtest_run(MEMTEST_OWN_ADDR, buf, TEST_ADDR,
+				TEST_WORDS * sizeof(ulong), TEST_PATTERN,
+				&res));
+	ut_asserteq(0, res.errors);
+
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_memtest_fail, 0);
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for parallel_for()
+ */
+
+#include <parallel.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define TEST_COUNT	1000
+
+struct par_test {
+	u8 hits[TEST_COUNT];
+	bool bad_cpu;
+};
+
+static void par_test_func(void *priv, ulong start, ulong end, int cpu)
+{
+	struct par_test *pt = priv;
+	ulong i;
+
+	if (cpu < 0 || cpu >= parallel_num_cpus())
+		pt->bad_cpu = true;
+	for (i = start; i < end; i++)
+		pt->hits[i]++;
+}
+
+static int check_hits(struct unit_test_state *uts, struct par_test *pt,
+		      ulong count)
+{
+	ulong i;
+
+	for (i = 0; i < count; i++)
+		ut_asserteq(1, pt->hits[i]);
+	for (; i < TEST_COUNT; i++)
+		ut_asserteq(0, pt->hits[i]);
+	ut_assert(!pt->bad_cpu);
+
+	return 0;
+}
+
+/* Test that each item is processed exactly once */
+static int lib_test_parallel_for(struct unit_test_state *uts)
+{
+	static struct par_test pt;
+	static const ulong grains[] = { 1, 7, 64, TEST_COUNT, TEST_COUNT * 2 };
+	int i;
+
+	ut_assert(parallel_num_cpus() >= 1);
+
+	for (i = 0; i < ARRAY_SIZE(grains); i++) {
+		memset(&pt, '\0', sizeof(pt));
+		ut_assertok(parallel_for(TEST_COUNT, grains[i], par_test_func,
+					 &pt));
+		ut_assertok(check_hits(uts, &pt, TEST_COUNT));
+	}
+
+	/* The last chunk must not run past the end */
+	memset(&pt, '\0', sizeof(pt));
+	ut_assertok(parallel_for(TEST_COUNT - 3, 10, par_test_func, &pt));
+	ut_assertok(check_hits(uts, &pt, TEST_COUNT - 3));
+
+	/* Nothing to do */
+	memset(&pt, '\0', sizeof(pt));
+	ut_assertok(parallel_for(0, 10, par_test_func, &pt));
+	ut_assertok(check_hits(uts, &pt, 0));
+
+	/* A zero grain is invalid */
+	ut_asserteq(-EINVAL, parallel_for(TEST_COUNT, 0, par_test_func, &pt));
+
+	return 0;
+}
+LIB_TEST(lib_test_parallel_for, 0);
+
+struct par_range {
+	ulong count;
+	ulong total;
+	ulong calls;
+	bool bad_range;
+};
+
+static void par_range_func(void *priv, ulong start, ulong end, int cpu)
+{
+	struct par_range *pr = priv;
+
+	if (start >= end || end > pr->count)
+		pr->bad_range = true;
+	__atomic_fetch_add(&pr->total, end - start, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&pr->calls, 1, __ATOMIC_RELAXED);
+}
+
+static int check_range(struct unit_test_state *uts, ulong count, ulong grain)
+{
+	struct par_range pr = { .count = count };
+
+	ut_assertok(parallel_for(count, grain, par_range_func, &pr));
+	ut_assert(!pr.bad_range);
+	ut_asserteq(count, pr.total);
+	ut_asserteq(count / grain + !!(count % grain), pr.calls);
+
+	return 0;
+}
+
+/* Test that counts and grains near the top of the range do not wrap */
+static int lib_test_parallel_for_wrap(struct unit_test_state *uts)
+{
+	ulong grain = ULONG_MAX / CONFIG_PARALLEL_MAX_CPUS + 1;
+
+	/* grain * CONFIG_PARALLEL_MAX_CPUS wraps to a small number */
+	ut_assertok(check_range(uts, ULONG_MAX - 10, grain));
+
+	/* the counter wraps after the last chunk */
+	ut_assertok(check_range(uts, ULONG_MAX, ULONG_MAX / 2 + 1));
+	ut_assertok(check_range(uts, ULONG_MAX, ULONG_MAX));
+
+	return 0;
+}
+LIB_TEST(lib_test_parallel_for_wrap, 0);
@@ -8,10 +8,12 @@
 
 #include <command.h>
 #include <image.h>
+#include <time.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
 #include <u-boot/rsa.h>
+#include <u-boot/rsa-mod-exp.h>
 
 #ifdef CONFIG_RSA_VERIFY_WITH_PKEY
 /*
@@ -202,4 +204,233 @@ static int lib_rsa_verify_invalid(struct unit_test_state *uts)
 }
 
 LIB_TEST(lib_rsa_verify_invalid, 0);
+
+/**
+ * lib_rsa_verify_32bit() - unit test for rsa_verify() using 32-bit words
+ *
+ * Test rsa_verify() with the 32-bit modular exponentiation, which is
+ * otherwise not used on 64-bit machines
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_verify_32bit(struct unit_test_state *uts)
+{
+	struct image_sign_info info;
+	struct image_region reg;
+	unsigned char ctmp;
+	int ret, ret_bad;
+
+	memset(&info, '\0', sizeof(info));
+	info.name = "sha256,rsa2048";
+	info.padding = image_get_padding_algo("pkcs-1.5");
+	info.checksum = image_get_checksum_algo("sha256,rsa2048");
+	info.crypto = image_get_crypto_algo(info.name);
+
+	info.key = public_key;
+	info.keylen = public_key_len;
+
+	reg.data = data_raw;
+	reg.size = data_raw_len;
+
+	rsa_mod_exp_set_32bit(true);
+	ret = rsa_verify(&info, &reg, 1, data_enc, data_enc_len);
+	ctmp = data_enc[data_enc_len - 10];
+	data_enc[data_enc_len - 10] = 0x12;
+	ret_bad = rsa_verify(&info, &reg, 1, data_enc, data_enc_len);
+	data_enc[data_enc_len - 10] = ctmp;
+	rsa_mod_exp_set_32bit(false);
+
+	ut_assertf(ret == 0, "verification unexpectedly failed (%d)\n", ret);
+	ut_assertf(ret_bad != 0, "verification unexpectedly succeeded\n");
+
+	return CMD_RET_SUCCESS;
+}
+
+LIB_TEST(lib_rsa_verify_32bit, 0);
+
+/*
+ * A 2080-bit modulus, which is an odd number of 32-bit words. It is not an
+ * RSA key, just a number to check the exponentiation with:
+ *
+ * n = random 2080-bit odd number, s = random number below n
+ * rr = 2^4160 mod n, n0inv = -1 / n mod 2^32, expect = s^65537 mod n
+ */
+static const u8 odd_modulus[] __aligned(4) = {
+	0xa3, 0x74, 0xa1, 0xc2, 0xef, 0xa2, 0xc5, 0x30, 0xa9, 0xd9, 0x54, 0x85,
+	0xef, 0x01, 0x5e, 0xa3, 0x28, 0xd1, 0x9b, 0x14, 0xfa, 0x21, 0x9e, 0x1d,
+	0xda, 0x15, 0xe8, 0x9a, 0x92, 0xa3, 0xa9, 0x5a, 0x79, 0x93, 0x6e, 0x99,
+	0xcc, 0xde, 0x69, 0xa3, 0x6b, 0x53, 0x57, 0xb0, 0x38, 0x51, 0x3b, 0xd8,
+	0x1c, 0xbd, 0x15, 0x0f, 0x4b, 0x46, 0x04, 0x6a, 0xbc, 0x86, 0x95, 0xdc,
+	0x53, 0xc7, 0xc7, 0xa8, 0x98, 0x98, 0xf3, 0x65, 0xb0, 0x55, 0x39, 0x65,
+	0xb6, 0xe1, 0xa3, 0xf2, 0xeb, 0xf4, 0x6a, 0x78, 0x8c, 0x54, 0xa2, 0x8c,
+	0x72, 0x73, 0x7e, 0x0f, 0xc4, 0x31, 0x73, 0x87, 0x06, 0x58, 0xc2, 0x3c,
+	0x54, 0xff, 0xfa, 0x2e, 0x10, 0x70, 0xae, 0x2b, 0xe8, 0x83, 0x7a, 0x7b,
+	0x4a, 0x23, 0x67, 0xe3, 0x35, 0xde, 0x3d, 0x9b, 0xc4, 0x37, 0x6d, 0x49,
+	0x02, 0xf9, 0x93, 0x61, 0xa5, 0x16, 0xb8, 0xe6, 0x5f, 0xdf, 0x63, 0xc5,
+	0xf9, 0xc4, 0x3f, 0x5e, 0x6b, 0x97, 0xbf, 0x70, 0x2c, 0x6a, 0x73, 0x9e,
+	0x23, 0x9a, 0x7c, 0x17, 0x42, 0x3d, 0xa2, 0x9c, 0xb7, 0x5a, 0x3b, 0x6a,
+	0x50, 0xb9, 0xcf, 0xf1, 0x88, 0x8b, 0x62, 0xf7, 0x92, 0x72, 0xc7, 0x3a,
+	0x33, 0xef, 0x0b, 0x53, 0x68, 0x92, 0x61, 0xbb, 0x69, 0x53, 0x12, 0x89,
+	0xf2, 0xef, 0x09, 0xae, 0x34, 0x32, 0xdd, 0xb8, 0x4a, 0x7f, 0x8e, 0xe0,
+	0x23, 0xe3, 0xdc, 0x94, 0x3b, 0x29, 0x1c, 0xef, 0xa3, 0x8c, 0xd6, 0x3c,
+	0xca, 0x71, 0x89, 0x3a, 0xac, 0x2a, 0x40, 0x55, 0x76, 0xec, 0x69, 0x7c,
+	0x9a, 0x51, 0x7c, 0xa8, 0x91, 0x83, 0xae, 0x54, 0x6f, 0x77, 0xfc, 0x84,
+	0x2a, 0xe5, 0x54, 0x0e, 0x50, 0x3f, 0x0c, 0xa3, 0x7b, 0x2f, 0xe2, 0xaf,
+	0x97, 0x30, 0x05, 0x37, 0xc1, 0x15, 0x46, 0x16, 0x6a, 0xf2, 0x65, 0x8d,
+	0x67, 0xf0, 0x16, 0x11, 0x0a, 0x76, 0xfb, 0xb9
+};
+
+static const u8 odd_rr[] __aligned(4) = {
+	0x32, 0x71, 0xb0, 0xd8, 0xa6, 0xae, 0xc0, 0x9d, 0x2f, 0x2e, 0x9b, 0xf7,
+	0xdd, 0x1c, 0x3d, 0xe3, 0x9c, 0xeb, 0x61, 0x4d, 0xdc, 0x88, 0x3c, 0x22,
+	0x90, 0xe6, 0xe9, 0x9a, 0xc9, 0xba, 0xe4, 0x9b, 0xdd, 0x00, 0x59, 0xc2,
+	0x57, 0x12, 0xeb, 0x68, 0x22, 0xbd, 0xa3, 0xbb, 0xcb, 0xe6, 0xa0, 0xda,
+	0x89, 0xdf, 0x3e, 0xc7, 0xca, 0xa4, 0x89, 0x90, 0x22, 0xe7, 0x7e, 0xaf,
+	0x04, 0x7e, 0x1b, 0x93, 0xbc, 0x40, 0x05, 0x2d, 0x66, 0x77, 0xb7, 0x87,
+	0x24, 0xed, 0xba, 0x15, 0x65, 0x3f, 0xab, 0xdf, 0xb4, 0xb2, 0x68, 0x46,
+	0x0a, 0x79, 0xf7, 0xa3, 0x74, 0xab, 0x94, 0x9a, 0xed, 0xe9, 0xc0, 0x8a,
+	0xf9, 0x7e, 0xf2, 0x30, 0x71, 0x84, 0xe3, 0xf6, 0x4b, 0x0a, 0xd7, 0x6b,
+	0x2a, 0xdf, 0x72, 0xc6, 0xa5, 0xd6, 0x7b, 0x99, 0x77, 0x51, 0x6d, 0x5c,
+	0xd3, 0x5c, 0x7c, 0x28, 0x23, 0x5e, 0xae, 0x66, 0x96, 0xbb, 0xe4, 0x92,
+	0xa7, 0x35, 0x83, 0x05, 0x99, 0x53, 0xf4, 0x6c, 0xb4, 0xa6, 0xb1, 0x69,
+	0x42, 0xdf, 0xb6, 0x86, 0x58, 0xc1, 0xdd, 0x34, 0x2c, 0xb3, 0xf6, 0xbe,
+	0xda, 0x9b, 0x67, 0xe7, 0x89, 0x44, 0x07, 0x5d, 0x5a, 0x98, 0x86, 0x0f,
+	0xa2, 0xb1, 0xd6, 0xbd, 0x59, 0x8f, 0x6c, 0x3f, 0x29, 0xea, 0x24, 0x99,
+	0x23, 0x07, 0x51, 0x1d, 0xf2, 0x91, 0x8d, 0xfc, 0x84, 0x23, 0x4a, 0x82,
+	0xc6, 0x98, 0xe7, 0x94, 0x5d, 0xb1, 0xfc, 0x7c, 0x77, 0x50, 0x3b, 0x61,
+	0xb3, 0xf5, 0xf6, 0xa7, 0x4c, 0xf0, 0xa8, 0x3f, 0xc5, 0x25, 0xee, 0x05,
+	0x14, 0x14, 0xa5, 0xd0, 0xcb, 0x48, 0x8d, 0x53, 0xf5, 0x97, 0x2d, 0xfc,
+	0x0a, 0x40, 0x59, 0xeb, 0x00, 0x19, 0x21, 0x94, 0x8d, 0xcb, 0xac, 0xc1,
+	0x0b, 0x04, 0x46, 0xbf, 0x96, 0xf3, 0x1a, 0x87, 0x71, 0x55, 0x2c, 0x7f,
+	0xbc, 0xb1, 0xa2, 0x10, 0x49, 0xa3, 0xcf, 0xbf
+};
+
+static const u8 odd_sig[] __aligned(4) = {
+	0x6c, 0x3c, 0xb7, 0xc9, 0x6f, 0x8e, 0xe2, 0x40, 0x10, 0xa5, 0x47, 0xf4,
+	0x24, 0x0d, 0x24, 0x9c, 0xdd, 0x9b, 0x4e, 0x21, 0xb4, 0xeb, 0x05, 0xd1,
+	0x14, 0x40, 0xfc, 0xd7, 0xd8, 0x86, 0x44, 0x91, 0x73, 0xfb, 0x1d, 0x44,
+	0x93, 0xe9, 0xb3, 0x94, 0xa8, 0x7e, 0x25, 0xbb, 0x39, 0x69, 0x76, 0x92,
+	0x62, 0x32, 0xb1, 0x47, 0x17, 0x15, 0xb1, 0xb1, 0x1c, 0xe8, 0x50, 0x94,
+	0x72, 0x80, 0x5a, 0xde, 0xb4, 0x5a, 0x7e, 0xac, 0x92, 0x38, 0xfe, 0x72,
+	0xc5, 0xe8, 0x57, 0x45, 0xa1, 0x29, 0x8b, 0x73, 0x07, 0x84, 0xb3, 0x83,
+	0x9e, 0x65, 0x11, 0xa2, 0xba, 0x2f, 0x97, 0x0f, 0x68, 0x4c, 0x40, 0xec,
+	0x29, 0xaa, 0x08, 0x2d, 0x49, 0x29, 0x89, 0x71, 0xe1, 0x0b, 0xb3, 0x9e,
+	0x54, 0xb9, 0xfd, 0x4a, 0xec, 0x7d, 0x9e, 0x5c, 0x9c, 0x2e, 0xc7, 0x36,
+	0x94, 0xfe, 0x2f, 0x23, 0x84, 0x1e, 0x11, 0x5b, 0x38, 0xaf, 0xb0, 0x21,
+	0xcc, 0x8d, 0x04, 0xf3, 0x15, 0x9b, 0x7c, 0xe6, 0x51, 0x7a, 0x69, 0xf2,
+	0x27, 0xab, 0x8c, 0x05, 0x6d, 0xf4, 0xd8, 0xae, 0x71, 0xe1, 0x90, 0x64,
+	0xfc, 0xd8, 0xda, 0x2f, 0x89, 0xb5, 0xd4, 0xed, 0x90, 0xc0, 0xcf, 0xa7,
+	0xb0, 0xb7, 0xc2, 0x1e, 0xf7, 0x9b, 0x9e, 0x0c, 0x85, 0xcf, 0xae, 0x61,
+	0xe4, 0x51, 0x3b, 0x6c, 0x29, 0x1a, 0xc8, 0xe3, 0x65, 0xaa, 0xea, 0x05,
+	0xf8, 0x86, 0x0e, 0x57, 0x62, 0xf4, 0x1b, 0x30, 0xb2, 0x77, 0x21, 0x68,
+	0xcc, 0x4e, 0x0c, 0xc0, 0xc5, 0x64, 0xa9, 0xb3, 0xde, 0xc8, 0x21, 0xfc,
+	0xf8, 0x10, 0xd4, 0x92, 0x14, 0x37, 0xb7, 0x8b, 0xc8, 0xd0, 0x41, 0xa4,
+	0x2b, 0xe7, 0xcf, 0xe2, 0xae, 0xc7, 0x0c, 0xd3, 0x4e, 0x5c, 0x81, 0x00,
+	0xdd, 0xbd, 0xf3, 0xca, 0x6e, 0x01, 0xa0, 0x03, 0xf4, 0x65, 0x21, 0x53,
+	0x51, 0xea, 0x51, 0xbe, 0x91, 0xd4, 0x14, 0x79
+};
+
+static const u8 odd_expect[] __aligned(4) = {
+	0x15, 0x1c, 0x72, 0x48, 0x0a, 0x31, 0xf9, 0xaf, 0x79, 0xbd, 0x2a, 0x34,
+	0x4c, 0x4c, 0xfd, 0xa3, 0xed, 0xe7, 0x46, 0x3f, 0xb7, 0x0c, 0xf2, 0x3c,
+	0xa6, 0xa1, 0xfe, 0xdc, 0x99, 0x21, 0xcb, 0x0a, 0x2f, 0x81, 0xcb, 0x2b,
+	0x1f, 0x99, 0x47, 0x76, 0xe8, 0x95, 0x77, 0x6f, 0x65, 0x3e, 0xa9, 0x0f,
+	0x8d, 0x42, 0x41, 0x20, 0xfa, 0x20, 0xa0, 0x32, 0x14, 0xb0, 0xa1, 0x37,
+	0xfb, 0x0e, 0x07, 0x93, 0x71, 0x5a, 0x11, 0x0d, 0x55, 0x3a, 0x62, 0xb8,
+	0x5f, 0x9f, 0x71, 0x08, 0xea, 0xfc, 0x32, 0xbd, 0xcc, 0x46, 0x59, 0x24,
+	0xf3, 0x78, 0x32, 0xb5, 0xc1, 0x56, 0x7d, 0xb9, 0x7e, 0x9c, 0x79, 0xbd,
+	0x59, 0xb1, 0x84, 0x73, 0x33, 0xf9, 0xe5, 0x13, 0x05, 0x54, 0xb2, 0x66,
+	0x96, 0x7f, 0x89, 0x77, 0xd6, 0x67, 0x9d, 0xa7, 0xa0, 0xd7, 0xc6, 0x90,
+	0x39, 0x4a, 0xe2, 0x58, 0xf7, 0x97, 0x88, 0xc0, 0xd4, 0x14, 0x5c, 0x0b,
+	0xb1, 0x3e, 0x59, 0x88, 0x2f, 0x2a, 0xe1, 0x86, 0x3e, 0xf1, 0x44, 0xf9,
+	0x0f, 0xdf, 0x1e, 0x00, 0xe6, 0x19, 0xd1, 0x4a, 0xb1, 0x5e, 0xc8, 0x80,
+	0x47, 0x00, 0x7b, 0x34, 0x61, 0x10, 0xec, 0x45, 0x99, 0xc3, 0xdb, 0x0c,
+	0x05, 0x12, 0x16, 0x04, 0x58, 0x57, 0x63, 0xab, 0x7a, 0xaf, 0x98, 0xf2,
+	0xb0, 0xcb, 0x7b, 0x16, 0xa9, 0xa5, 0x7c, 0x25, 0xc1, 0xd3, 0xaa, 0x0b,
+	0xe6, 0x87, 0xbb, 0x3c, 0x45, 0xee, 0x4d, 0xb8, 0xfe, 0x28, 0xcc, 0xe8,
+	0x2f, 0xee, 0x4d, 0x81, 0x02, 0xca, 0xca, 0x50, 0x6c, 0x81, 0xe4, 0xc0,
+	0x9a, 0x64, 0xef, 0xca, 0x21, 0x3f, 0x7e, 0x73, 0xd0, 0xb1, 0xf4, 0xc4,
+	0x55, 0x72, 0xe5, 0x5a, 0xce, 0x93, 0x21, 0x9b, 0xd9, 0x25, 0x13, 0x89,
+	0x51, 0x89, 0xd6, 0xc7, 0x03, 0x4e, 0xfc, 0x88, 0xd1, 0x3e, 0x3c, 0x6e,
+	0xd5, 0x42, 0xd1, 0xc1, 0xb4, 0xe0, 0xbe, 0xb7
+};
+
+#define ODD_N0INV 0xc6e96577
+
+/**
+ * lib_rsa_mod_exp_odd() - unit test for rsa_mod_exp_sw()
+ *
+ * Test rsa_mod_exp_sw() with a key that has an odd number of 32-bit words,
+ * which cannot use 64-bit words, with and without 32-bit words being forced
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_mod_exp_odd(struct unit_test_state *uts)
+{
+	struct key_prop prop;
+	u8 out[sizeof(odd_sig)];
+	int ret, i;
+
+	memset(&prop, '\0', sizeof(prop));
+	prop.modulus = odd_modulus;
+	prop.rr = odd_rr;
+	prop.n0inv = ODD_N0INV;
+	prop.num_bits = sizeof(odd_modulus) * 8;
+
+	for (i = 0; i < 2; i++) {
+		memset(out, '\0', sizeof(out));
+		rsa_mod_exp_set_32bit(i);
+		ret = rsa_mod_exp_sw(odd_sig, sizeof(odd_sig), &prop, out);
+		rsa_mod_exp_set_32bit(false);
+		ut_assertok(ret);
+		ut_asserteq_mem(odd_expect, out, sizeof(out));
+	}
+
+	return CMD_RET_SUCCESS;
+}
+
+LIB_TEST(lib_rsa_mod_exp_odd, 0);
+
+#define RSA_BENCH_COUNT	100
+
+/**
+ * lib_rsa_verify_bench_norun() - benchmark rsa_verify()
+ *
+ * This shows how long a signature check takes, which is mostly the modular
+ * exponentiation. Run it with 'ut -f lib lib_rsa_verify_bench_norun'.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_verify_bench_norun(struct unit_test_state *uts)
+{
+	struct image_sign_info info;
+	struct image_region reg;
+	ulong start, us;
+	int i;
+
+	memset(&info, '\0', sizeof(info));
+	info.name = "sha256,rsa2048";
+	info.padding = image_get_padding_algo("pkcs-1.5");
+	info.checksum = image_get_checksum_algo("sha256,rsa2048");
+	info.crypto = image_get_crypto_algo(info.name);
+
+	info.key = public_key;
+	info.keylen = public_key_len;
+
+	reg.data = data_raw;
+	reg.size = data_raw_len;
+
+	start = timer_get_us();
+	for (i = 0; i < RSA_BENCH_COUNT; i++)
+		ut_assertok(rsa_verify(&info, &reg, 1, data_enc, data_enc_len));
+	us = timer_get_us() - start;
+
+	printf("rsa2048: %lu us per verification\n", us / RSA_BENCH_COUNT);
+
+	return 0;
+}
+LIB_TEST(lib_rsa_verify_bench_norun, UT_TESTF_MANUAL);
 #endif /* RSA_VERIFY_WITH_PKEY */
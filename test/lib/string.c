@@ -11,9 +11,13 @@
 
 #include <command.h>
 #include <log.h>
+#include <malloc.h>
+#include <time.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
 
 /* Xor mask used for marking memory regions */
 #define MASK 0xA5
@@ -224,3 +228,160 @@ static int lib_memdup(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(lib_memdup, 0);
+
+/* Sizes used for large-copy tests, around the thresholds of arch routines */
+static const int large_sizes[] = { 255, 256, 257, 1000, 4099, 65541 };
+
+/* Largest size in large_sizes, plus room for alignment offsets */
+#define LARGE_BUFLEN	(65541 + 16)
+
+static void init_large(u8 *buf, int len, u8 mask)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = (i * 7 + (i >> 8)) ^ mask;
+}
+
+/**
+ * lib_mem_large() - unit test for memset(), memcpy() and memmove() on
+ * larger regions
+ *
+ * Architecture routines switch to different code (e.g. vector or
+ * string instructions) for larger sizes, which the tests above do not
+ * reach. The results are checked against the portable routines.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_mem_large(struct unit_test_state *uts)
+{
+	u8 *src, *dst, *ref;
+	int i, off, len;
+
+	src = malloc(LARGE_BUFLEN);
+	dst = malloc(LARGE_BUFLEN);
+	ref = malloc(LARGE_BUFLEN);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+	ut_assertnonnull(ref);
+	init_large(src, LARGE_BUFLEN, 0);
+
+	for (i = 0; i < ARRAY_SIZE(large_sizes); i++) {
+		len = large_sizes[i];
+		for (off = 0; off < 8; off++) {
+			/* memset() */
+			init_large(dst, LARGE_BUFLEN, MASK);
+			init_large(ref, LARGE_BUFLEN, MASK);
+			memset_generic(ref + off, 0x5a, len);
+			ut_asserteq_ptr(dst + off, memset(dst + off, 0x5a, len));
+			ut_asserteq_mem(ref, dst, LARGE_BUFLEN);
+
+			/* memcpy() with differing alignment */
+			init_large(dst, LARGE_BUFLEN, MASK);
+			init_large(ref, LARGE_BUFLEN, MASK);
+			memcpy_generic(ref + off, src + 8 - off, len);
+			ut_asserteq_ptr(dst + off,
+					memcpy(dst + off, src + 8 - off, len));
+			ut_asserteq_mem(ref, dst, LARGE_BUFLEN);
+
+			/* memmove() in both directions */
+			memcpy(dst, src, LARGE_BUFLEN);
+			memmove(dst + off + 1, dst, len);
+			ut_asserteq_mem(src, dst + off + 1, len);
+			memcpy(dst, src, LARGE_BUFLEN);
+			memmove(dst, dst + off + 1, len);
+			ut_asserteq_mem(src + off + 1, dst, len);
+		}
+	}
+	free(ref);
+	free(dst);
+	free(src);
+
+	return 0;
+}
+LIB_TEST(lib_mem_large, 0);
+
+/* Sizes used by the benchmark */
+static const int bench_sizes[] = { 64, 256, 4096, SZ_64K, SZ_1M };
+
+/* Total number of bytes to process for each size in the benchmark */
+#define BENCH_TOTAL	SZ_16M
+
+static ulong bench_mbps(ulong bytes, ulong us)
+{
+	return us ? div_u64((u64)bytes * 1000000, us) >> 20 : 0;
+}
+
+/**
+ * lib_mem_bench_norun() - benchmark memset(), memcpy() and memmove()
+ *
+ * This shows the throughput of the routines in this build, next to that of
+ * the portable versions in lib/string.c. Where the architecture has its own
+ * routines this shows the benefit of them; otherwise the two are the same.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_mem_bench_norun(struct unit_test_state *uts)
+{
+	u8 *src, *dst;
+	ulong start, us[6];
+	int i, j, len, count;
+
+	src = malloc(SZ_1M + 64);
+	dst = malloc(SZ_1M + 64);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+	init_large(src, SZ_1M + 64, 0);
+
+	printf("%8s %17s %17s %17s (MB/s)\n", "", "memset", "memcpy",
+	       "memmove");
+	printf("%8s %8s %8s %8s %8s %8s %8s\n", "size", "arch", "generic",
+	       "arch", "generic", "arch", "generic");
+	for (i = 0; i < ARRAY_SIZE(bench_sizes); i++) {
+		len = bench_sizes[i];
+		count = BENCH_TOTAL / len;
+
+		start = timer_get_us();
+		for (j = 0; j < count; j++)
+			memset(dst, j, len);
+		us[0] = timer_get_us() - start;
+
+		start = timer_get_us();
+		for (j = 0; j < count; j++)
+			memset_generic(dst, j, len);
+		us[1] = timer_get_us() - start;
+
+		start = timer_get_us();
+		for (j = 0; j < count; j++)
+			memcpy(dst, src, len);
+		us[2] = timer_get_us() - start;
+
+		start = timer_get_us();
+		for (j = 0; j < count; j++)
+			memcpy_generic(dst, src, len);
+		us[3] = timer_get_us() - start;
+		ut_asserteq_mem(src, dst, len);
+
+		start = timer_get_us();
+		for (j = 0; j < count; j++)
+			memmove(dst + 1, dst, len);
+		us[4] = timer_get_us() - start;
+
+		start = timer_get_us();
+		for (j = 0; j < count; j++)
+			memmove_generic(dst + 1, dst, len);
+		us[5] = timer_get_us() - start;
+
+		printf("%8d", len);
+		for (j = 0; j < ARRAY_SIZE(us); j++)
+			printf(" %8lu", bench_mbps(BENCH_TOTAL, us[j]));
+		printf("\n");
+	}
+	free(dst);
+	free(src);
+
+	return 0;
+}
+LIB_TEST(lib_mem_bench_norun, UT_TESTF_MANUAL);
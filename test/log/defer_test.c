@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test writing log output to the console in the background
+ */
+
+#include <console.h>
+#include <cyclic.h>
+#include <asm/global_data.h>
+#include <linux/delay.h>
+#include <test/log.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Check that log output stays in order with other console output */
+static int log_test_defer_order(struct unit_test_state *uts)
+{
+	int log_fmt = gd->log_fmt;
+
+	gd->log_fmt = BIT(LOGF_MSG);
+	log_console_flush();
+	console_record_reset_enable();
+	log_info("defer1\n");
+	ut_asserteq(7, log_console_pending());
+
+	/* other output writes out the log output first */
+	printf("normal\n");
+	ut_asserteq(0, log_console_pending());
+	log_info("defer2\n");
+	ut_asserteq(7, log_console_pending());
+
+	/* so does output sent straight to a console file */
+	fputs(stdout, "");
+	ut_asserteq(0, log_console_pending());
+	log_info("defer3\n");
+	ut_asserteq(7, log_console_pending());
+	fputs(stderr, "");
+	ut_asserteq(0, log_console_pending());
+	gd->log_fmt = log_fmt;
+
+	ut_assert_nextline("defer1");
+	ut_assert_nextline("normal");
+	ut_assert_nextline("defer2");
+	ut_assert_nextline("defer3");
+	ut_assert_console_end();
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_defer_order, UT_TESTF_CONSOLE_REC);
+
+/* Check that the cyclic function writes out log output */
+static int log_test_defer_cyclic(struct unit_test_state *uts)
+{
+	int log_fmt = gd->log_fmt;
+
+	gd->log_fmt = BIT(LOGF_MSG);
+	log_console_flush();
+	console_record_reset_enable();
+	log_info("cyc\n");
+	gd->log_fmt = log_fmt;
+	ut_asserteq(4, log_console_pending());
+
+	mdelay(CONFIG_LOG_CONSOLE_DEFER_DELAY_US / 1000 + 1);
+	schedule();
+	ut_asserteq(0, log_console_pending());
+	ut_assert_nextline("cyc");
+	ut_assert_console_end();
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_defer_cyclic, UT_TESTF_CONSOLE_REC);
+
+#define DEFER_FILL_COUNT	(CONFIG_LOG_CONSOLE_DEFER_SIZE / 8)
+
+/* Check that a full buffer is written out and nothing is lost */
+static int log_test_defer_full(struct unit_test_state *uts)
+{
+	int log_fmt = gd->log_fmt;
+	int pending, prev = 0;
+	bool drained = false;
+	int i;
+
+	gd->log_fmt = BIT(LOGF_MSG);
+	log_console_flush();
+	console_record_reset_enable();
+	for (i = 0; i < DEFER_FILL_COUNT; i++) {
+		log_info("fill%04d\n", i);
+		pending = log_console_pending();
+		ut_assert(pending < CONFIG_LOG_CONSOLE_DEFER_SIZE);
+		if (pending < prev)
+			drained = true;
+		prev = pending;
+	}
+	gd->log_fmt = log_fmt;
+
+	/* 9 bytes per record is more than the buffer holds */
+	ut_assert(drained);
+	ut_assert(pending > 0);
+
+	for (i = 0; i < DEFER_FILL_COUNT; i++)
+		ut_assert_nextline("fill%04d", i);
+	ut_assert_console_end();
+
+	log_console_flush();
+	ut_asserteq(0, log_console_pending());
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_defer_full, UT_TESTF_CONSOLE_REC);
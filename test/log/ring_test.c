@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test keeping log records in memory and showing them with 'log dump'
+ */
+
+#include <command.h>
+#include <console.h>
+#include <asm/global_data.h>
+#include <test/log.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static int log_test_ring_dump(struct unit_test_state *uts)
+{
+	int log_fmt = gd->log_fmt;
+
+	gd->log_fmt = BIT(LOGF_LEVEL) | BIT(LOGF_CAT) | BIT(LOGF_MSG);
+	console_record_reset_enable();
+	log(LOGC_ARCH, LOGL_ERR, "ring%d\n", 1);
+	log(LOGC_EFI, LOGL_WARNING, "ring%d\n", 2);
+	log(LOGC_BOOT, LOGL_INFO, "ring%d\n", 3);
+	ut_assert_nextline("ERR.arch, ring1");
+	ut_assert_nextline("WARNING.efi, ring2");
+	ut_assert_nextline("INFO.boot, ring3");
+
+	ut_assertok(run_command("log dump 2", 0));
+	ut_assert_nextline("WARNING.efi, ring2");
+	ut_assert_nextline("INFO.boot, ring3");
+	ut_assert_console_end();
+
+	/* the format in use when the records are shown applies */
+	gd->log_fmt = BIT(LOGF_MSG);
+	ut_assertok(run_command("log dump 3", 0));
+	ut_assert_nextline("ring1");
+	ut_assert_nextline("ring2");
+	ut_assert_nextline("ring3");
+	ut_assert_console_end();
+	gd->log_fmt = log_fmt;
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_ring_dump, UT_TESTF_CONSOLE_REC);
+
+static int log_test_ring_wrap(struct unit_test_state *uts)
+{
+	int log_fmt = gd->log_fmt;
+	int i;
+
+	/* fill the ring several times over, without using the console */
+	ut_assertok(log_device_set_enable(LOG_GET_DRIVER(console), false));
+	for (i = 0; i < CONFIG_LOG_RING_SIZE / 8; i++)
+		log_err("wrap%d\n", i);
+	ut_assertok(log_device_set_enable(LOG_GET_DRIVER(console), true));
+
+	gd->log_fmt = BIT(LOGF_MSG);
+	console_record_reset_enable();
+	ut_asserteq(2, log_ring_dump(2));
+	ut_assert_nextline("wrap%d", i - 2);
+	ut_assert_nextline("wrap%d", i - 1);
+	ut_assert_console_end();
+	gd->log_fmt = log_fmt;
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_ring_wrap, UT_TESTF_CONSOLE_REC);
+
+static int log_test_ring_names(struct unit_test_state *uts)
+{
+	int log_fmt = gd->log_fmt;
+	char file[] = "name.c", func[] = "name";
+
+	gd->log_fmt = LOGF_ALL;
+	console_record_reset_enable();
+
+	/* 'log rec' passes names which are freed when the command finishes */
+	ut_assertok(run_command("log rec arch notice file.c 123 func msg", 0));
+	ut_assert_nextline("NOTICE.arch,file.c:123-func() msg");
+
+	/* the names must be copied, not referenced */
+	_log(LOGC_BOOT, LOGL_ERR, file, 45, func, "rec\n");
+	ut_assert_nextline("ERR.boot,name.c:45-name() rec");
+	strcpy(file, "gone.c");
+	strcpy(func, "gone");
+
+	ut_assertok(run_command("log dump 2", 0));
+	ut_assert_nextline("NOTICE.arch,file.c:123-func() msg");
+	ut_assert_nextline("ERR.boot,name.c:45-name() rec");
+	ut_assert_console_end();
+	gd->log_fmt = log_fmt;
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_ring_names, UT_TESTF_CONSOLE_REC);
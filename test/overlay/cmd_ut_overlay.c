@@ -10,6 +10,7 @@
 #include <image.h>
 #include <log.h>
 #include <malloc.h>
+#include <of_overlay.h>
 
 #include <linux/sizes.h>
 
@@ -274,6 +275,21 @@ int do_ut_overlay(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 
 	ret = cmd_ut_category("overlay", "", tests, n_ents, argc, argv);
 
+	/* Run the same tests on the overlays applied using a live tree */
+	if (!ret && IS_ENABLED(CONFIG_OF_LIVE_OVERLAY)) {
+		struct of_overlay_ctx ctx;
+
+		ut_assertok(fdt_open_into(fdt_base, fdt, FDT_COPY_SIZE));
+		ut_assertok(of_overlay_start(&ctx, fdt));
+		ut_assertok(of_overlay_add(&ctx, fdt_overlay));
+		ut_assertok(of_overlay_add(&ctx, fdt_overlay_stacked));
+		ut_assertok(of_overlay_finish(&ctx, fdt, FDT_COPY_SIZE));
+		of_overlay_uninit(&ctx);
+
+		ret = cmd_ut_category("overlay-live", "", tests, n_ents, argc,
+				      argv);
+	}
+
 	free(fdt_overlay_stacked_copy);
 err3:
 	free(fdt_overlay_copy);